@@ -19,7 +19,7 @@ build_project()
   echo "Build ${project}"
   mkdir -p build/${dir}
   if [ -z ${wasm} ]; then
-    c++ -std=c++17 -I. -o build/${dir}/${project} ${path} `sdl2-config --cflags --libs`
+    c++ -std=c++17 -pthread -I. -o build/${dir}/${project} ${path} `sdl2-config --cflags --libs`
   else
     emcc -c ${path} -o build/${dir}/${project}.o -s USE_SDL=2 --std=c++17 -I.
     emcc build/${dir}/${project}.o -o build/${dir}/${project}.html -s USE_SDL=2
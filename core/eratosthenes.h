@@ -1,6 +1,9 @@
 ﻿#ifndef _ERATOSTHENES_H_
 #define _ERATOSTHENES_H_
 
+#include "parallel.h"
+
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -9,25 +12,58 @@ namespace core
 
 using EratosthenesTable = std::vector<bool>;
 
+// Segments are whole words of the table, so workers never share one
+constexpr long long SieveSegment = 1 << 16;
+
 EratosthenesTable sift(long long number)
 {
 	EratosthenesTable table(number + 1, false);
-	for(long long i = 4; i <= number; i += 2)
-	{
-		table[i] = true;
-	}
-	
-	long long next = 3;
 	long long const stop = std::sqrt(number);
-	while(next <= stop)
+	if (number < 2 * SieveSegment)
 	{
-		for (long long i = next * next; i <= number; i += next)
+		for(long long i = 4; i <= number; i += 2)
 		{
 			table[i] = true;
 		}
-		next += 2;
-		while(next <= number && table[next]) next += 2;
+
+		long long next = 3;
+		while(next <= stop)
+		{
+			for (long long i = next * next; i <= number; i += next)
+			{
+				table[i] = true;
+			}
+			next += 2;
+			while(next <= number && table[next]) next += 2;
+		}
+		return table;
+	}
+
+	auto const small = sift(stop);
+	std::vector<long long> primes;
+	for (long long p = 3; p <= stop; p += 2)
+	{
+		if (!small[p]) primes.push_back(p);
 	}
+
+	auto const segments = static_cast<size_t>(number / SieveSegment + 1);
+	parallel_range(0, segments,
+		[&table, &primes, number](size_t first, size_t last)
+		{
+			for (auto s = first; s < last; ++s)
+			{
+				auto const low = static_cast<long long>(s) * SieveSegment;
+				auto const high = std::min(number + 1, low + SieveSegment);
+				for (auto i = std::max(4ll, low); i < high; i += 2) table[i] = true;
+				for (auto p: primes)
+				{
+					if (p * p >= high) break;
+					auto const start = std::max(p * p, (low + p - 1) / p * p);
+					for (auto i = start; i < high; i += p) table[i] = true;
+				}
+			}
+		},
+		1);
 	return table;
 }
 
@@ -0,0 +1,74 @@
+﻿#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace core
+{
+
+// Read only memory mapping of a whole file
+class MappedFile
+{
+public:
+	explicit MappedFile(std::string const& path)
+	{
+		auto const fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw std::runtime_error{"cannot open " + path};
+
+		struct stat info;
+		if (::fstat(fd, &info) != 0)
+		{
+			::close(fd);
+			throw std::runtime_error{"cannot stat " + path};
+		}
+
+		size_ = static_cast<size_t>(info.st_size);
+		if (size_ > 0)
+		{
+			auto const data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				::close(fd);
+				throw std::runtime_error{"cannot map " + path};
+			}
+			data_ = static_cast<char const*>(data);
+		}
+		::close(fd);
+	}
+
+	~MappedFile()
+	{
+		if (data_) ::munmap(const_cast<char*>(data_), size_);
+	}
+
+	MappedFile(MappedFile&& other) noexcept:
+		data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+	MappedFile& operator=(MappedFile&& other) noexcept
+	{
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		return *this;
+	}
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	char const* data() const { return data_; }
+	size_t size() const { return size_; }
+
+private:
+	char const* data_{nullptr};
+	size_t size_{0};
+};
+
+} // namespace core
+
+#endif // _MAPPED_FILE_H_
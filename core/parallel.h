@@ -0,0 +1,141 @@
+﻿#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace core
+{
+
+// func(chunk, first, last) is called for every contiguous chunk of [begin, end)
+template<typename F>
+void parallel_chunks(size_t begin, size_t end, F&& func, unsigned threads = concurrency())
+{
+	if (end <= begin) return;
+	auto const size = end - begin;
+	auto const chunks = std::max<size_t>(1, std::min<size_t>(threads, size));
+	auto const step = (size + chunks - 1) / chunks;
+
+	if (chunks == 1)
+	{
+		func(size_t{0}, begin, end);
+		return;
+	}
+
+	TaskGroup group;
+	for (size_t c = 1; c < chunks; ++c)
+	{
+		auto const first = begin + c * step;
+		auto const last = std::min(end, first + step);
+		if (first >= last) break;
+		group.run([&func, c, first, last] { func(c, first, last); });
+	}
+	func(size_t{0}, begin, std::min(end, begin + step));
+	group.wait();
+}
+
+template<typename F>
+void parallel_for(size_t begin, size_t end, F&& func, unsigned threads = concurrency())
+{
+	parallel_chunks(begin, end,
+		[&func](size_t, size_t first, size_t last)
+		{
+			for (auto i = first; i < last; ++i) func(i);
+		},
+		threads);
+}
+
+// Grain zero picks one that gives every thread of the pool a few ranges
+size_t default_grain(size_t size)
+{
+	return std::max<size_t>(1, size / (8 * (default_pool().size() + 1)));
+}
+
+// func(first, last) is called for ranges of at most grain items, the
+// ranges are split in halves and the halves are stolen by idle workers
+template<typename F>
+void parallel_range(size_t begin, size_t end, F&& func, size_t grain = 0)
+{
+	if (end <= begin) return;
+	if (grain == 0) grain = default_grain(end - begin);
+	if (end - begin <= grain)
+	{
+		func(begin, end);
+		return;
+	}
+
+	auto const middle = begin + (end - begin) / 2;
+	TaskGroup group;
+	group.run([&func, middle, end, grain] { parallel_range(middle, end, func, grain); });
+	parallel_range(begin, middle, func, grain);
+	group.wait();
+}
+
+// Folds func(first, last) of the ranges with combine, the ranges are
+// split as in parallel_range and combined in their order
+template<typename V, typename F, typename C>
+V parallel_reduce(size_t begin, size_t end, V identity, F&& func, C&& combine, size_t grain = 0)
+{
+	if (end <= begin) return identity;
+	if (grain == 0) grain = default_grain(end - begin);
+	if (end - begin <= grain) return combine(identity, func(begin, end));
+
+	auto const middle = begin + (end - begin) / 2;
+	V right = identity;
+	TaskGroup group;
+	group.run([&, middle, end, grain] { right = parallel_reduce(middle, end, identity, func, combine, grain); });
+	auto left = parallel_reduce(begin, middle, identity, func, combine, grain);
+	group.wait();
+	return combine(std::move(left), std::move(right));
+}
+
+constexpr size_t SortGrain = 1 << 14;
+
+// Chunks are sorted in parallel and merged pairwise, every merge round
+// runs its merges in parallel
+template<typename It, typename Compare>
+void parallel_sort(It first, It last, Compare comp, unsigned threads = concurrency())
+{
+	auto const size = static_cast<size_t>(last - first);
+	auto const chunks = std::max<size_t>(1, std::min<size_t>(threads, size / SortGrain));
+	if (chunks == 1)
+	{
+		std::sort(first, last, comp);
+		return;
+	}
+
+	auto const step = (size + chunks - 1) / chunks;
+	parallel_for(0, chunks,
+		[first, size, step, &comp](size_t c)
+		{
+			std::sort(first + c * step, first + std::min(size, (c + 1) * step), comp);
+		},
+		threads);
+
+	for (auto width = step; width < size; width *= 2)
+	{
+		auto const merges = (size + 2 * width - 1) / (2 * width);
+		parallel_for(0, merges,
+			[first, size, width, &comp](size_t m)
+			{
+				auto const low = m * 2 * width;
+				auto const middle = std::min(size, low + width);
+				auto const high = std::min(size, low + 2 * width);
+				if (middle < high) std::inplace_merge(first + low, first + middle, first + high, comp);
+			},
+			threads);
+	}
+}
+
+template<typename It>
+void parallel_sort(It first, It last)
+{
+	parallel_sort(first, last, std::less<>{});
+}
+
+} // namespace core
+
+#endif // _PARALLEL_H_
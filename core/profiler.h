@@ -1,6 +1,7 @@
 ﻿#ifndef _PROFILER_H_
 #define _PROFILER_H_
 
+#include <chrono>
 #include <ctime>
 
 namespace core
@@ -24,6 +25,25 @@ private:
 	std::clock_t started_;
 };
 
+// Measures elapsed real time, CPU time of Profiler sums all the threads
+class WallProfiler
+{
+public:
+	explicit WallProfiler()
+	{
+		started_ = std::chrono::steady_clock::now();
+	}
+	
+	double time_ms() const
+	{
+		auto finished = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(finished - started_).count();
+	}
+	
+private:
+	std::chrono::steady_clock::time_point started_;
+};
+
 } // namespace core
 
 #endif // _PROFILER_H_
@@ -0,0 +1,295 @@
+﻿#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+
+unsigned concurrency()
+{
+	auto const n = std::thread::hardware_concurrency();
+	return n == 0 ? 1 : n;
+}
+
+// Chase-Lev deque: the owner pushes and pops at the bottom, thieves take
+// from the top. Outgrown buffers are kept until the deque dies since a
+// thief may still read from them
+template<typename T>
+class WorkDeque
+{
+	struct Buffer
+	{
+		explicit Buffer(size_t capacity): mask{capacity - 1}, items{new std::atomic<T*>[capacity]} {}
+
+		size_t capacity() const { return mask + 1; }
+		T* get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+		void put(int64_t i, T* item) { items[i & mask].store(item, std::memory_order_relaxed); }
+
+		size_t mask;
+		std::unique_ptr<std::atomic<T*>[]> items;
+	};
+
+public:
+	explicit WorkDeque(size_t capacity = 256)
+	{
+		buffers_.push_back(std::make_unique<Buffer>(capacity));
+		buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+	}
+
+	WorkDeque(WorkDeque const&) = delete;
+	WorkDeque& operator=(WorkDeque const&) = delete;
+
+	bool empty() const
+	{
+		return bottom_.load(std::memory_order_acquire) <= top_.load(std::memory_order_acquire);
+	}
+
+	void push(T* item)
+	{
+		auto const b = bottom_.load(std::memory_order_relaxed);
+		auto const t = top_.load(std::memory_order_acquire);
+		auto* buffer = buffer_.load(std::memory_order_relaxed);
+		if (b - t >= static_cast<int64_t>(buffer->capacity()))
+		{
+			buffers_.push_back(std::make_unique<Buffer>(2 * buffer->capacity()));
+			auto* grown = buffers_.back().get();
+			for (auto i = t; i < b; ++i) grown->put(i, buffer->get(i));
+			buffer_.store(grown, std::memory_order_release);
+			buffer = grown;
+		}
+		buffer->put(b, item);
+		bottom_.store(b + 1, std::memory_order_release);
+	}
+
+	T* pop()
+	{
+		auto const b = bottom_.load(std::memory_order_relaxed) - 1;
+		auto* buffer = buffer_.load(std::memory_order_relaxed);
+		bottom_.store(b, std::memory_order_seq_cst);
+		auto t = top_.load(std::memory_order_seq_cst);
+		if (t > b)
+		{
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		auto* item = buffer->get(b);
+		if (t == b)
+		{
+			// Last item, race the thieves for it
+			if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				item = nullptr;
+			bottom_.store(b + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	T* steal()
+	{
+		auto t = top_.load(std::memory_order_seq_cst);
+		auto const b = bottom_.load(std::memory_order_seq_cst);
+		if (t >= b) return nullptr;
+		auto* item = buffer_.load(std::memory_order_acquire)->get(t);
+		if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return item;
+	}
+
+private:
+	std::atomic<int64_t> top_{0};
+	std::atomic<int64_t> bottom_{0};
+	std::atomic<Buffer*> buffer_{nullptr};
+	std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+// Work stealing pool: every worker owns a deque, tasks submitted by a
+// worker go to its own deque, others go to the shared queue. An idle
+// worker takes from its deque, then the shared queue, then steals from
+// the others and sleeps only when nothing is queued anywhere
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+	explicit ThreadPool(unsigned workers = concurrency() - 1)
+	{
+		deques_.reserve(workers);
+		for (unsigned i = 0; i < workers; ++i) deques_.push_back(std::make_unique<WorkDeque<Task>>());
+		workers_.reserve(workers);
+		for (unsigned i = 0; i < workers; ++i) workers_.emplace_back([this, i] { work(i); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			stop_ = true;
+		}
+		ready_.notify_all();
+		for (auto& w: workers_) w.join();
+	}
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	size_t size() const { return workers_.size(); }
+
+	void submit(Task task)
+	{
+		auto* item = new Task{std::move(task)};
+		auto const& self = identity();
+		queued_.fetch_add(1, std::memory_order_seq_cst);
+		if (self.pool == this) deques_[self.index]->push(item);
+		else
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			shared_.push_back(item);
+		}
+		if (sleeping_.load(std::memory_order_seq_cst) > 0)
+		{
+			{ std::lock_guard<std::mutex> lock{mutex_}; }
+			ready_.notify_one();
+		}
+	}
+
+	// Lets a waiting thread help instead of blocking
+	bool run_pending()
+	{
+		auto const& self = identity();
+		std::unique_ptr<Task> task{take(self.pool == this ? self.index : deques_.size())};
+		if (!task) return false;
+		(*task)();
+		return true;
+	}
+
+private:
+	struct Identity
+	{
+		ThreadPool const* pool{nullptr};
+		size_t index{0};
+	};
+
+	static Identity& identity()
+	{
+		thread_local Identity self;
+		return self;
+	}
+
+	Task* take(size_t self)
+	{
+		Task* task = nullptr;
+		if (self < deques_.size()) task = deques_[self]->pop();
+		if (!task && queued_.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			if (!shared_.empty())
+			{
+				task = shared_.front();
+				shared_.pop_front();
+			}
+		}
+		for (size_t i = 1; !task && i <= deques_.size(); ++i) task = deques_[(self + i) % deques_.size()]->steal();
+		if (task) queued_.fetch_sub(1, std::memory_order_relaxed);
+		return task;
+	}
+
+	void work(size_t index)
+	{
+		identity() = {this, index};
+		while (true)
+		{
+			if (std::unique_ptr<Task> task{take(index)})
+			{
+				(*task)();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock{mutex_};
+			sleeping_.fetch_add(1, std::memory_order_seq_cst);
+			ready_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_seq_cst) > 0; });
+			sleeping_.fetch_sub(1, std::memory_order_relaxed);
+			if (stop_ && queued_.load(std::memory_order_relaxed) == 0) return;
+		}
+	}
+
+	std::vector<std::unique_ptr<WorkDeque<Task>>> deques_;
+	std::mutex mutex_;
+	std::condition_variable ready_;
+	std::deque<Task*> shared_;
+	std::atomic<size_t> queued_{0};
+	std::atomic<unsigned> sleeping_{0};
+	bool stop_{false};
+	std::vector<std::thread> workers_;
+};
+
+ThreadPool& default_pool()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+// Tasks run on the pool, wait() helps running queued tasks until all the
+// tasks of the group are done and rethrows the first exception of them
+class TaskGroup
+{
+public:
+	explicit TaskGroup(ThreadPool& pool = default_pool()): pool_{pool} {}
+	~TaskGroup()
+	{
+		while (pending_.load(std::memory_order_acquire) != 0) help();
+	}
+
+	TaskGroup(TaskGroup const&) = delete;
+	TaskGroup& operator=(TaskGroup const&) = delete;
+
+	template<typename F>
+	void run(F&& func)
+	{
+		pending_.fetch_add(1, std::memory_order_relaxed);
+		pool_.submit([this, func = std::forward<F>(func)]() mutable
+		{
+			try
+			{
+				func();
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				if (!error_) error_ = std::current_exception();
+			}
+			pending_.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	void wait()
+	{
+		while (pending_.load(std::memory_order_acquire) != 0) help();
+		std::lock_guard<std::mutex> lock{mutex_};
+		if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+	}
+
+private:
+	void help()
+	{
+		if (!pool_.run_pending()) std::this_thread::yield();
+	}
+
+	ThreadPool& pool_;
+	std::atomic<size_t> pending_{0};
+	std::mutex mutex_;
+	std::exception_ptr error_;
+};
+
+} // namespace core
+
+#endif // _THREAD_POOL_H_
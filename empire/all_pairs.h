@@ -3,13 +3,22 @@
 
 #include "graph.h"
 
+#include "../core/parallel.h"
+
+#include <algorithm>
 #include <numeric>
+#include <unordered_map>
+#include <vector>
 
 namespace empire
 {
 template<typename T>
 T inf = std::numeric_limits<T>::max();
 
+constexpr size_t AllPairsGrain = 64;
+
+// Floyd-Warshall over dense matrices of node indexes, every round of
+// the via node relaxes the rows in parallel
 template<typename T>
 class AllPairs
 {
@@ -17,85 +26,100 @@ public:
 	using node_type = typename T::node_type;
 	using cost_type = typename T::link_type::cost_type;
 
-	explicit AllPairs(T const& graph): graph_{graph}
+	explicit AllPairs(T const& graph, unsigned threads = core::concurrency()): graph_{graph}
 	{
 		init();
-		precalc();
+		precalc(threads);
 	}
 
 	std::vector<node_type*> find_path(node_type* from, node_type* to) const
 	{
-		if (distance_.at(from).at(to) == inf<cost_type>) return {};
-		auto const via = via_.at(from).at(to);
-		if (via == to) return {from, to};
-		auto head = find_path(from, via);
-		auto tail = find_path(via, to);
-		head.insert(std::end(head), std::next(std::begin(tail)), std::end(tail));
-		return head;
+		return find_path(ids_.at(from), ids_.at(to));
 	}
 
 private:
 	void init();
-	void precalc();
+	void precalc(unsigned threads);
+	std::vector<node_type*> find_path(size_t from, size_t to) const;
 
 	T const& graph_;
 
-	using Distance = std::unordered_map<node_type const*,
-		std::unordered_map<node_type const*, cost_type>>;
-	Distance distance_;
-
-	using Via = std::unordered_map<node_type const*,
-		std::unordered_map<node_type const*, node_type*>>;
-	Via via_;
+	size_t size_{0};
+	std::unordered_map<node_type const*, size_t> ids_;
+	std::vector<node_type*> nodes_;
+	std::vector<cost_type> distance_;
+	std::vector<size_t> via_;
 };
 
 template<typename T>
 void AllPairs<T>::init()
 {
-	for(auto const& nfrom: graph_)
+	size_ = graph_.size();
+	nodes_.reserve(size_);
+	for (auto const& node: graph_)
 	{
-		auto from = nfrom.get();
-		for (auto const& nto: graph_)
-		{
-			auto to = nto.get();
-			distance_[from][to] = inf<cost_type>;
-		}
-		distance_[from][from] = cost_type{};
-		via_[from][from] = from;
-		for (auto l: from->links)
+		ids_.emplace(node.get(), nodes_.size());
+		nodes_.push_back(node.get());
+	}
+
+	distance_.assign(size_ * size_, inf<cost_type>);
+	via_.assign(size_ * size_, 0);
+	for (size_t from = 0; from < size_; ++from)
+	{
+		distance_[from * size_ + from] = cost_type{};
+		via_[from * size_ + from] = from;
+		for (auto const& l: nodes_[from]->links)
 		{
-			const auto to = l.to;
-			distance_[from][to] = l.cost;
-			via_[from][to] = to;
+			auto const to = ids_.at(l.to);
+			distance_[from * size_ + to] = l.cost;
+			via_[from * size_ + to] = to;
 		}
 	}
 }
 
 template<typename T>
-void AllPairs<T>::precalc()
+void AllPairs<T>::precalc(unsigned threads)
 {
-	for(auto const& nvia: graph_)
+	std::vector<cost_type> through(size_);
+	for (size_t via = 0; via < size_; ++via)
 	{
-		auto via = nvia.get();
-		for (auto const& nfrom: graph_)
-		{
-			auto from = nfrom.get();
-			for (auto const& nto: graph_)
+		std::copy_n(std::begin(distance_) + via * size_, size_, std::begin(through));
+		core::parallel_chunks(0, size_,
+			[this, via, &through](size_t, size_t first, size_t last)
 			{
-				auto to = nto.get();
-				if (distance_[from][via] == inf<cost_type>) continue;
-				if (distance_[via][to] == inf<cost_type>) continue;
-				auto const distance = distance_[from][via] + distance_[via][to];
-				if (distance < distance_[from][to])
+				for (auto from = first; from < last; ++from)
 				{
-					distance_[from][to] = distance;
-					via_[from][to] = via;
+					auto* row = distance_.data() + from * size_;
+					auto const head = row[via];
+					if (head == inf<cost_type>) continue;
+					for (size_t to = 0; to < size_; ++to)
+					{
+						if (through[to] == inf<cost_type>) continue;
+						auto const distance = head + through[to];
+						if (distance < row[to])
+						{
+							row[to] = distance;
+							via_[from * size_ + to] = via;
+						}
+					}
 				}
-			}
-		}
+			},
+			static_cast<unsigned>(std::min<size_t>(threads, size_ / AllPairsGrain + 1)));
 	}
 }
 
+template<typename T>
+std::vector<typename AllPairs<T>::node_type*> AllPairs<T>::find_path(size_t from, size_t to) const
+{
+	if (distance_[from * size_ + to] == inf<cost_type>) return {};
+	auto const via = via_[from * size_ + to];
+	if (via == to) return {nodes_[from], nodes_[to]};
+	auto head = find_path(from, via);
+	auto tail = find_path(via, to);
+	head.insert(std::end(head), std::next(std::begin(tail)), std::end(tail));
+	return head;
+}
+
 } // namespace empire
 
 #endif // _ALL_PAIRS_H_
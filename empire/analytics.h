@@ -0,0 +1,263 @@
+﻿#ifndef _ANALYTICS_H_
+#define _ANALYTICS_H_
+
+#include "csr.h"
+
+#include "../core/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace empire
+{
+
+struct PageRankOptions
+{
+	double damping{0.85};
+	double tolerance{1e-9};
+	int iterations{100};
+};
+
+struct PageRank
+{
+	std::vector<double> ranks;
+	int iterations{0};
+	bool converged{false};
+};
+
+namespace
+{
+
+constexpr size_t AnalyticsGrain = 4096;
+
+unsigned analytics_workers(unsigned threads, size_t size)
+{
+	return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, size / AnalyticsGrain + 1)));
+}
+
+// Sums func(chunk, first, last) over the chunks of [0, size)
+template<typename F>
+double parallel_sum(size_t size, unsigned workers, F&& func)
+{
+	std::vector<double> partial(workers, 0.0);
+	core::parallel_chunks(0, size,
+		[&partial, &func](size_t chunk, size_t first, size_t last) { partial[chunk] = func(first, last); },
+		workers);
+	return std::accumulate(std::begin(partial), std::end(partial), 0.0);
+}
+
+} // namespace
+
+// Pull PageRank: every node gathers the contributions of its sources,
+// contributions and ranks are flat arrays updated in branch free loops.
+// Ranks of dangling nodes are spread over all the nodes, the iteration
+// stops when the L1 change drops below the tolerance
+template<typename T>
+PageRank page_rank(Csr<T> const& csr, PageRankOptions const& options = {},
+	unsigned threads = core::concurrency())
+{
+	auto const n = csr.size();
+	PageRank result;
+	if (n == 0) return result;
+
+	auto const transposed = make_transposed(csr);
+	auto const workers = analytics_workers(threads, n);
+	auto const base = (1.0 - options.damping) / n;
+
+	std::vector<double> inverse(n);
+	for (size_t v = 0; v < n; ++v) inverse[v] = csr.degree(v) ? 1.0 / csr.degree(v) : 0.0;
+
+	result.ranks.assign(n, 1.0 / n);
+	std::vector<double> contributions(n);
+	std::vector<double> next(n);
+	while (result.iterations < options.iterations && !result.converged)
+	{
+		auto const dangling = parallel_sum(n, workers,
+			[&](size_t first, size_t last)
+			{
+				double sum = 0.0;
+				for (auto v = first; v < last; ++v)
+				{
+					contributions[v] = result.ranks[v] * inverse[v];
+					sum += inverse[v] == 0.0 ? result.ranks[v] : 0.0;
+				}
+				return sum;
+			});
+
+		auto const teleport = base + options.damping * dangling / n;
+		auto const error = parallel_sum(n, workers,
+			[&](size_t first, size_t last)
+			{
+				double sum = 0.0;
+				for (auto v = first; v < last; ++v)
+				{
+					double gathered = 0.0;
+					for (auto i = transposed.offsets[v]; i < transposed.offsets[v + 1]; ++i)
+						gathered += contributions[transposed.sources[i]];
+					next[v] = teleport + options.damping * gathered;
+					sum += std::abs(next[v] - result.ranks[v]);
+				}
+				return sum;
+			});
+
+		result.ranks.swap(next);
+		++result.iterations;
+		result.converged = error < options.tolerance;
+	}
+	return result;
+}
+
+// Brandes on unweighted links, sources are taken by the workers from
+// a shared counter and every worker sums into its own array
+template<typename T>
+std::vector<double> betweenness_centrality(Csr<T> const& csr, unsigned threads = core::concurrency())
+{
+	auto const n = csr.size();
+	auto const workers = std::max(1u, threads);
+	std::vector<std::vector<double>> partial(workers);
+	std::atomic<size_t> next{0};
+
+	core::parallel_chunks(0, workers,
+		[&](size_t worker, size_t, size_t)
+		{
+			auto& centrality = partial[worker];
+			centrality.assign(n, 0.0);
+			std::vector<size_t> order;
+			std::vector<double> paths(n, 0.0);
+			std::vector<double> dependency(n, 0.0);
+			std::vector<size_t> distance(n, std::numeric_limits<size_t>::max());
+			order.reserve(n);
+
+			for (auto s = next.fetch_add(1); s < n; s = next.fetch_add(1))
+			{
+				order.assign(1, s);
+				paths[s] = 1.0;
+				distance[s] = 0;
+				for (size_t head = 0; head < order.size(); ++head)
+				{
+					auto const v = order[head];
+					for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+					{
+						auto const w = csr.targets[e];
+						if (distance[w] == std::numeric_limits<size_t>::max())
+						{
+							distance[w] = distance[v] + 1;
+							order.push_back(w);
+						}
+						if (distance[w] == distance[v] + 1) paths[w] += paths[v];
+					}
+				}
+
+				for (auto it = std::rbegin(order); it != std::rend(order); ++it)
+				{
+					auto const v = *it;
+					for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+					{
+						auto const w = csr.targets[e];
+						if (distance[w] == distance[v] + 1)
+							dependency[v] += paths[v] / paths[w] * (1.0 + dependency[w]);
+					}
+					if (v != s) centrality[v] += dependency[v];
+				}
+
+				for (auto v: order)
+				{
+					paths[v] = 0.0;
+					dependency[v] = 0.0;
+					distance[v] = std::numeric_limits<size_t>::max();
+				}
+			}
+		},
+		workers);
+
+	std::vector<double> centrality(n, 0.0);
+	core::parallel_for(0, n,
+		[&partial, &centrality](size_t v)
+		{
+			for (auto const& p: partial) centrality[v] += p[v];
+		},
+		analytics_workers(threads, n));
+	return centrality;
+}
+
+// Core numbers by parallel peeling: the nodes with degree not above k
+// are removed in rounds, neighbours that drop to k join the next round
+std::vector<size_t> core_numbers(Adjacency const& adjacency, unsigned threads = core::concurrency())
+{
+	auto const n = adjacency.size();
+	auto const workers = analytics_workers(threads, n);
+	std::vector<std::atomic<size_t>> degrees(n);
+	std::vector<char> removed(n, 0);
+	std::vector<size_t> cores(n, 0);
+	for (size_t v = 0; v < n; ++v) degrees[v].store(adjacency.degree(v), std::memory_order_relaxed);
+
+	std::vector<size_t> remaining(n);
+	std::iota(std::begin(remaining), std::end(remaining), 0);
+	std::vector<std::vector<size_t>> parts(workers);
+	auto join = [&parts](std::vector<size_t>& to)
+	{
+		to.clear();
+		for (auto& p: parts)
+		{
+			to.insert(std::end(to), std::begin(p), std::end(p));
+			p.clear();
+		}
+	};
+
+	std::vector<size_t> frontier;
+	for (size_t k = 0; !remaining.empty(); ++k)
+	{
+		auto lowest = std::numeric_limits<size_t>::max();
+		for (auto v: remaining) lowest = std::min(lowest, degrees[v].load(std::memory_order_relaxed));
+		k = std::max(k, lowest);
+		core::parallel_chunks(0, remaining.size(),
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = remaining[i];
+					if (degrees[v].load(std::memory_order_relaxed) <= k) parts[chunk].push_back(v);
+				}
+			},
+			workers);
+		join(frontier);
+
+		while (!frontier.empty())
+		{
+			for (auto v: frontier)
+			{
+				removed[v] = 1;
+				cores[v] = k;
+			}
+			core::parallel_chunks(0, frontier.size(),
+				[&](size_t chunk, size_t first, size_t last)
+				{
+					for (auto i = first; i < last; ++i)
+					{
+						auto const v = frontier[i];
+						for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+						{
+							auto const u = adjacency.targets[e];
+							if (removed[u]) continue;
+							if (degrees[u].fetch_sub(1, std::memory_order_relaxed) == k + 1)
+								parts[chunk].push_back(u);
+						}
+					}
+				},
+				analytics_workers(threads, frontier.size()));
+			join(frontier);
+		}
+
+		remaining.erase(std::remove_if(std::begin(remaining), std::end(remaining),
+			[&removed](size_t v) { return removed[v] != 0; }), std::end(remaining));
+	}
+	return cores;
+}
+
+} // namespace empire
+
+#endif // _ANALYTICS_H_
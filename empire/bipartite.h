@@ -0,0 +1,152 @@
+﻿#ifndef _BIPARTITE_H_
+#define _BIPARTITE_H_
+
+#include "coloring.h"
+#include "components.h"
+
+#include "../core/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+namespace empire
+{
+
+// Sides are 0 and 1 when the graph is bipartite, otherwise odd_cycle
+// holds the vertexes of an odd cycle in path order and sides are partial
+struct Bipartition
+{
+	Coloring sides;
+	std::vector<size_t> odd_cycle;
+
+	bool is_bipartite() const { return odd_cycle.empty(); }
+};
+
+namespace
+{
+
+constexpr size_t NoParent = std::numeric_limits<size_t>::max();
+
+// The tree paths from v and u meet at their common ancestor,
+// with the edge (v, u) they close a cycle of odd length
+std::vector<size_t> odd_cycle(std::vector<size_t> const& parents,
+	std::vector<size_t> const& depths, size_t v, size_t u)
+{
+	std::vector<size_t> head;
+	std::vector<size_t> tail;
+	while (depths[v] > depths[u]) { head.push_back(v); v = parents[v]; }
+	while (depths[u] > depths[v]) { tail.push_back(u); u = parents[u]; }
+	while (v != u)
+	{
+		head.push_back(v);
+		tail.push_back(u);
+		v = parents[v];
+		u = parents[u];
+	}
+	head.push_back(v);
+	head.insert(std::end(head), std::rbegin(tail), std::rend(tail));
+	return head;
+}
+
+// Breadth first search of the component of the root, returns false
+// and fills the cycle on the first edge with equal sides
+bool two_color_from(Adjacency const& adjacency, size_t root, Coloring& sides,
+	std::vector<size_t>& parents, std::vector<size_t>& depths,
+	std::vector<size_t>& queue, std::vector<size_t>& cycle)
+{
+	sides[root] = 0;
+	parents[root] = NoParent;
+	depths[root] = 0;
+	queue.assign(1, root);
+	for (size_t head = 0; head < queue.size(); ++head)
+	{
+		auto const v = queue[head];
+		for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+		{
+			auto const u = adjacency.targets[e];
+			if (sides[u] == NoColor)
+			{
+				sides[u] = 1 - sides[v];
+				parents[u] = v;
+				depths[u] = depths[v] + 1;
+				queue.push_back(u);
+			}
+			else if (sides[u] == sides[v])
+			{
+				cycle = odd_cycle(parents, depths, v, u);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+Bipartition bipartition(Adjacency const& adjacency)
+{
+	auto const n = adjacency.size();
+	Bipartition result;
+	result.sides.assign(n, NoColor);
+	std::vector<size_t> parents(n);
+	std::vector<size_t> depths(n);
+	std::vector<size_t> queue;
+	for (size_t v = 0; v < n; ++v)
+	{
+		if (result.sides[v] != NoColor) continue;
+		if (!two_color_from(adjacency, v, result.sides, parents, depths, queue, result.odd_cycle)) break;
+	}
+	return result;
+}
+
+// Components are labeled in parallel and then searched by the workers,
+// every component is owned by one worker so the arrays are not shared.
+// The witness is the one of the failing component with the smallest id
+Bipartition parallel_bipartition(Adjacency const& adjacency, unsigned threads = core::concurrency())
+{
+	auto const n = adjacency.size();
+	auto const components = connected_components(adjacency, threads);
+	auto const count = components.count;
+
+	std::vector<size_t> roots(count, NoParent);
+	for (size_t v = n; v > 0; --v) roots[components.ids[v - 1]] = v - 1;
+
+	Bipartition result;
+	result.sides.assign(n, NoColor);
+	std::vector<size_t> parents(n);
+	std::vector<size_t> depths(n);
+
+	std::atomic<size_t> next{0};
+	std::atomic<size_t> failed{count};
+	std::vector<std::vector<size_t>> cycles(std::max(1u, threads));
+	std::vector<size_t> cycle_ids(cycles.size(), count);
+	core::parallel_chunks(0, cycles.size(),
+		[&](size_t worker, size_t, size_t)
+		{
+			std::vector<size_t> queue;
+			std::vector<size_t> cycle;
+			while (true)
+			{
+				auto const c = next.fetch_add(1, std::memory_order_relaxed);
+				if (c >= failed.load(std::memory_order_relaxed)) return;
+				if (two_color_from(adjacency, roots[c], result.sides, parents, depths, queue, cycle)) continue;
+
+				cycles[worker] = std::move(cycle);
+				cycle_ids[worker] = c;
+				auto current = failed.load(std::memory_order_relaxed);
+				while (c < current && !failed.compare_exchange_weak(current, c, std::memory_order_relaxed)) {}
+				return;
+			}
+		},
+		static_cast<unsigned>(cycles.size()));
+
+	auto const first = std::min_element(std::begin(cycle_ids), std::end(cycle_ids)) - std::begin(cycle_ids);
+	if (cycle_ids[first] != count) result.odd_cycle = std::move(cycles[first]);
+	return result;
+}
+
+} // namespace empire
+
+#endif // _BIPARTITE_H_
@@ -0,0 +1,377 @@
+﻿#ifndef _COLORING_H_
+#define _COLORING_H_
+
+#include "csr.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace empire
+{
+
+constexpr int NoColor = -1;
+
+using Coloring = std::vector<int>;
+using Ordering = std::vector<size_t>;
+
+int count_colors(Coloring const& coloring)
+{
+	if (coloring.empty()) return 0;
+	return *std::max_element(std::begin(coloring), std::end(coloring)) + 1;
+}
+
+bool is_proper(Adjacency const& adjacency, Coloring const& coloring)
+{
+	for (size_t v = 0; v < adjacency.size(); ++v)
+	{
+		if (coloring[v] == NoColor) return false;
+		for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+		{
+			if (coloring[adjacency.targets[e]] == coloring[v]) return false;
+		}
+	}
+	return true;
+}
+
+namespace
+{
+
+class ColorMarks
+{
+public:
+	void clear() { ++stamp_; }
+
+	void mark(int color)
+	{
+		if (color == NoColor) return;
+		if (static_cast<size_t>(color) >= marks_.size()) marks_.resize(color + 1, 0);
+		marks_[color] = stamp_;
+	}
+
+	int first_free() const
+	{
+		size_t color = 0;
+		while (color < marks_.size() && marks_[color] == stamp_) ++color;
+		return static_cast<int>(color);
+	}
+
+private:
+	std::vector<size_t> marks_;
+	size_t stamp_{1};
+};
+
+template<typename F>
+int smallest_free_color(Adjacency const& adjacency, size_t v, F&& color_of, ColorMarks& marks)
+{
+	marks.clear();
+	for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+		marks.mark(color_of(adjacency.targets[e]));
+	return marks.first_free();
+}
+
+int smallest_free_color(Adjacency const& adjacency, Coloring const& coloring,
+	size_t v, ColorMarks& marks)
+{
+	return smallest_free_color(adjacency, v, [&coloring](size_t u) { return coloring[u]; }, marks);
+}
+
+// Intrusive doubly linked lists of vertexes, one list per key
+class Buckets
+{
+public:
+	Buckets(size_t n, size_t keys): heads_(keys, none), next_(n, none), prev_(n, none), key_(n, none) {}
+
+	static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+	size_t head(size_t key) const { return heads_[key]; }
+	size_t next(size_t v) const { return next_[v]; }
+	size_t key(size_t v) const { return key_[v]; }
+	size_t keys() const { return heads_.size(); }
+
+	void push(size_t v, size_t key)
+	{
+		key_[v] = key;
+		prev_[v] = none;
+		next_[v] = heads_[key];
+		if (heads_[key] != none) prev_[heads_[key]] = v;
+		heads_[key] = v;
+	}
+
+	void erase(size_t v)
+	{
+		if (prev_[v] != none) next_[prev_[v]] = next_[v];
+		else heads_[key_[v]] = next_[v];
+		if (next_[v] != none) prev_[next_[v]] = prev_[v];
+		key_[v] = none;
+	}
+
+	void move(size_t v, size_t key)
+	{
+		erase(v);
+		push(v, key);
+	}
+
+private:
+	std::vector<size_t> heads_;
+	std::vector<size_t> next_;
+	std::vector<size_t> prev_;
+	std::vector<size_t> key_;
+};
+
+} // namespace
+
+Coloring greedy_coloring(Adjacency const& adjacency, Ordering const& ordering)
+{
+	Coloring coloring(adjacency.size(), NoColor);
+	ColorMarks marks;
+	for (auto v: ordering) coloring[v] = smallest_free_color(adjacency, coloring, v, marks);
+	return coloring;
+}
+
+Ordering welsh_powell_order(Adjacency const& adjacency)
+{
+	Ordering ordering(adjacency.size());
+	std::iota(std::begin(ordering), std::end(ordering), 0);
+	std::stable_sort(std::begin(ordering), std::end(ordering),
+		[&adjacency](size_t a, size_t b) { return adjacency.degree(a) > adjacency.degree(b); });
+	return ordering;
+}
+
+Ordering smallest_last_order(Adjacency const& adjacency)
+{
+	auto const n = adjacency.size();
+	size_t max_degree = 0;
+	for (size_t v = 0; v < n; ++v) max_degree = std::max(max_degree, adjacency.degree(v));
+
+	Buckets buckets{n, max_degree + 1};
+	for (size_t v = 0; v < n; ++v) buckets.push(v, adjacency.degree(v));
+
+	Ordering ordering(n);
+	std::vector<bool> removed(n, false);
+	size_t min = 0;
+	for (size_t i = n; i > 0; --i)
+	{
+		while (buckets.head(min) == Buckets::none) ++min;
+		auto const v = buckets.head(min);
+		buckets.erase(v);
+		removed[v] = true;
+		ordering[i - 1] = v;
+		for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+		{
+			auto const u = adjacency.targets[e];
+			if (removed[u]) continue;
+			buckets.move(u, buckets.key(u) - 1);
+		}
+		if (min > 0) --min;
+	}
+	return ordering;
+}
+
+Coloring welsh_powell_coloring(Adjacency const& adjacency)
+{
+	return greedy_coloring(adjacency, welsh_powell_order(adjacency));
+}
+
+Coloring smallest_last_coloring(Adjacency const& adjacency)
+{
+	return greedy_coloring(adjacency, smallest_last_order(adjacency));
+}
+
+// Picks the uncolored vertex of the highest saturation, ties go to the
+// higher degree in the uncolored subgraph and then to the lower id. The
+// heap keeps stale entries: a rise in saturation pushes a new one, a drop
+// in degree is only fixed when the entry comes up. Every vertex marks the
+// colors of its neighbours, so the whole run takes O(m log n)
+Coloring dsatur_coloring(Adjacency const& adjacency)
+{
+	struct Entry
+	{
+		size_t saturation;
+		size_t degree;
+		size_t v;
+
+		bool operator<(Entry const& other) const
+		{
+			if (saturation != other.saturation) return saturation < other.saturation;
+			if (degree != other.degree) return degree < other.degree;
+			return v > other.v;
+		}
+	};
+
+	auto const n = adjacency.size();
+	std::vector<size_t> degrees(n);
+	std::vector<Entry> entries;
+	entries.reserve(n);
+	for (size_t v = 0; v < n; ++v)
+	{
+		degrees[v] = adjacency.degree(v);
+		entries.push_back({0, degrees[v], v});
+	}
+	std::priority_queue<Entry> heap{std::less<Entry>{}, std::move(entries)};
+
+	Coloring coloring(n, NoColor);
+	std::vector<size_t> saturations(n, 0);
+	std::vector<std::vector<bool>> neighbour_colors(n);
+	ColorMarks marks;
+	while (!heap.empty())
+	{
+		auto const [saturation, degree, v] = heap.top();
+		heap.pop();
+		if (coloring[v] != NoColor || saturation != saturations[v]) continue;
+		if (degree != degrees[v])
+		{
+			heap.push({saturation, degrees[v], v});
+			continue;
+		}
+		coloring[v] = smallest_free_color(adjacency, coloring, v, marks);
+		std::vector<bool>().swap(neighbour_colors[v]);
+
+		for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+		{
+			auto const u = adjacency.targets[e];
+			if (coloring[u] != NoColor) continue;
+			--degrees[u];
+			auto& colors = neighbour_colors[u];
+			auto const color = static_cast<size_t>(coloring[v]);
+			if (color >= colors.size()) colors.resize(color + 1, false);
+			if (colors[color]) continue;
+			colors[color] = true;
+			heap.push({++saturations[u], degrees[u], u});
+		}
+	}
+	return coloring;
+}
+
+struct TabuOptions
+{
+	int iterations{10000};
+	int tenure{10};
+	double alpha{0.6};
+	unsigned seed{0};
+};
+
+namespace
+{
+
+// TabuCol search for a conflict free coloring with k colors
+bool tabu_search(Adjacency const& adjacency, Coloring& coloring, int k,
+	TabuOptions const& options, std::default_random_engine& engine)
+{
+	auto const n = adjacency.size();
+	std::vector<int> gamma(n * k, 0);
+	std::vector<int> tabu(n * k, 0);
+
+	int conflicts = 0;
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+		{
+			auto const u = adjacency.targets[e];
+			++gamma[v * k + coloring[u]];
+			if (v < u && coloring[u] == coloring[v]) ++conflicts;
+		}
+	}
+
+	std::vector<size_t> conflicting;
+	std::vector<size_t> position(n, Buckets::none);
+	auto update = [&](size_t v)
+	{
+		auto const conflict = gamma[v * k + coloring[v]] > 0;
+		if (conflict && position[v] == Buckets::none)
+		{
+			position[v] = conflicting.size();
+			conflicting.push_back(v);
+		}
+		else if (!conflict && position[v] != Buckets::none)
+		{
+			auto const last = conflicting.back();
+			conflicting[position[v]] = last;
+			position[last] = position[v];
+			conflicting.pop_back();
+			position[v] = Buckets::none;
+		}
+	};
+	for (size_t v = 0; v < n; ++v) update(v);
+
+	int best = conflicts;
+	for (int iteration = 0; iteration < options.iterations && conflicts > 0; ++iteration)
+	{
+		auto best_delta = std::numeric_limits<int>::max();
+		size_t best_v = 0;
+		int best_color = NoColor;
+		int ties = 0;
+		for (auto v: conflicting)
+		{
+			auto const own = gamma[v * k + coloring[v]];
+			for (int c = 0; c < k; ++c)
+			{
+				if (c == coloring[v]) continue;
+				auto const delta = gamma[v * k + c] - own;
+				auto const aspiration = conflicts + delta < best;
+				if (tabu[v * k + c] > iteration && !aspiration) continue;
+				if (delta < best_delta)
+				{
+					best_delta = delta;
+					best_v = v;
+					best_color = c;
+					ties = 1;
+				}
+				else if (delta == best_delta &&
+					std::uniform_int_distribution<int>{0, ties++}(engine) == 0)
+				{
+					best_v = v;
+					best_color = c;
+				}
+			}
+		}
+		if (best_color == NoColor) continue;
+
+		auto const old = coloring[best_v];
+		coloring[best_v] = best_color;
+		conflicts += best_delta;
+		best = std::min(best, conflicts);
+		tabu[best_v * k + old] = iteration + options.tenure +
+			static_cast<int>(options.alpha * conflicting.size());
+		for (auto e = adjacency.offsets[best_v]; e < adjacency.offsets[best_v + 1]; ++e)
+		{
+			auto const u = adjacency.targets[e];
+			--gamma[u * k + old];
+			++gamma[u * k + best_color];
+			update(u);
+		}
+		update(best_v);
+	}
+	return conflicts == 0;
+}
+
+} // namespace
+
+// Removes the last color of a proper coloring while the tabu search succeeds
+Coloring tabu_coloring(Adjacency const& adjacency, Coloring coloring, TabuOptions const& options = {})
+{
+	std::default_random_engine engine{options.seed};
+	auto k = count_colors(coloring);
+	while (k > 1)
+	{
+		auto attempt = coloring;
+		for (auto& c: attempt)
+			if (c == k - 1) c = std::uniform_int_distribution<int>{0, k - 2}(engine);
+		if (!tabu_search(adjacency, attempt, k - 1, options, engine)) break;
+		coloring = std::move(attempt);
+		--k;
+	}
+	return coloring;
+}
+
+Coloring tabu_coloring(Adjacency const& adjacency)
+{
+	return tabu_coloring(adjacency, dsatur_coloring(adjacency));
+}
+
+} // namespace empire
+
+#endif // _COLORING_H_
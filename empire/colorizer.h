@@ -1,14 +1,14 @@
 ﻿#ifndef _COLORIZER_H_
 #define _COLORIZER_H_
 
+#include "bipartite.h"
+#include "coloring.h"
 #include "view.h"
 
 #include "../bwgui/color.h"
 #include "../core/logger.h"
 
-#include <queue>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace
@@ -28,297 +28,256 @@ void print_error(T const& v)
 	std::cerr << "Impossible to color " << v.node->value << '\n';
 }
 
-template<typename T>
-bool operator==(std::reference_wrapper<T> const& lhs, std::reference_wrapper<T> const& rhs)
-{ return lhs.get() == rhs.get(); }
-
 template<typename T>
 struct Triple { T k, m, n; };
 
+// Vertexes are dense ids, merged vertexes get ids after the original ones.
+// Degrees are kept in bucket lists, adjacency is CSR where rows of merged
+// vertexes are appended and old ids are resolved with union-find
 template<typename T>
-struct ColorNode
+class Simplifier
 {
-	using color_node_ref = std::reference_wrapper<ColorNode<T>>;
-	
-	struct Hash
-	{
-		std::size_t operator()(color_node_ref const& v) const noexcept
-		{ return v.get().hash(); }
-	};
+public:
+	using node_type = typename T::node_type;
+	using Ids = std::vector<size_t>;
 
-	using ColorNodeRefUSet = std::unordered_set<color_node_ref, Hash>;
+	static constexpr size_t none = empire::Buckets::none;
 
-	ColorNode() = delete;
-	explicit ColorNode(T* n): node{n} {}
-	ColorNode(color_node_ref k, color_node_ref m, color_node_ref n);
+	explicit Simplifier(T& view);
 
-	bool is_packed() const { return merged_.has_value(); }
-	Triple<color_node_ref> unpack() const { return *merged_; }
+	void simplify(int n);
 
-	std::size_t hash() const;
+	size_t size() const { return nodes_.size(); }
+	node_type* node(size_t v) const { return nodes_[v]; }
+	empire::Adjacency const& adjacency() const { return adjacency_; }
 
-	bool is_neighbor(color_node_ref v) const { return neighbors.count(v) == 1; }
+	bool is_packed(size_t v) const { return v >= nodes_.size(); }
+	Triple<size_t> unpack(size_t v) const { return merged_[v - nodes_.size()]; }
 
-	void bind(color_node_ref v) { neighbors.insert(v); }
-	void unbind(color_node_ref v) { neighbors.erase(v); }
-	void bind();
-	void unbind();
+	template<typename F>
+	void for_each_member(size_t v, F&& func) const
+	{
+		for (auto m = head_[v]; m != none; m = next_[m]) func(m);
+	}
 
-	T* node;
-	ColorNodeRefUSet neighbors;
+	Ids const& base() const { return base_; }
+	Ids const& extracted() const { return extracted_; }
 
 private:
-	std::optional<Triple<color_node_ref>> merged_;
+	size_t find(size_t v);
+
+	template<typename F>
+	void for_each_neighbor(size_t v, F&& func);
+
+	bool is_neighbor(size_t v, size_t u);
+	void remove(size_t v);
+	bool pull(int limit);
+	bool pack();
+	void merge(size_t k, size_t m, size_t n);
+	void update(size_t v, size_t degree) { degree_[v] = degree; buckets_.move(v, degree); }
+
+	std::vector<node_type*> nodes_;
+	empire::Adjacency adjacency_;
+
+	Ids offsets_;
+	Ids targets_;
+	Ids parent_;
+	Ids degree_;
+	Ids marks_;
+	size_t stamp_{0};
+	std::vector<bool> removed_;
+	empire::Buckets buckets_{0, 0};
+
+	Ids head_;
+	Ids tail_;
+	Ids next_;
+	std::vector<Triple<size_t>> merged_;
+
+	Ids base_;
+	Ids extracted_;
 };
 
 template<typename T>
-bool operator==(ColorNode<T> const& lhs, ColorNode<T> const& rhs)
-{ return lhs.node == rhs.node; }
-
-template<typename T>
-ColorNode<T>::ColorNode(color_node_ref k, color_node_ref m, color_node_ref n)
-{
-	merged_ = Triple<color_node_ref>{k, m, n};
-	for (auto v: m.get().neighbors) bind(v);
-	for (auto v: n.get().neighbors) bind(v);
-	unbind(k);
-}
-
-template<typename T>
-void ColorNode<T>::bind()
+Simplifier<T>::Simplifier(T& view)
 {
-	color_node_ref self{*this};
-	for (auto& n: neighbors)
+	std::unordered_map<node_type const*, size_t> ids;
+	nodes_.reserve(view.vertexes.size());
+	for (auto const& [node, _]: view.vertexes)
 	{
-		n.get().bind(self);
+		ids.emplace(node, nodes_.size());
+		nodes_.push_back(node);
 	}
-}
 
-template<typename T>
-void ColorNode<T>::unbind()
-{
-	color_node_ref self{*this};
-	for (auto& n: neighbors)
+	empire::Edges edges;
+	for (size_t v = 0; v < nodes_.size(); ++v)
 	{
-		n.get().unbind(self);
+		for (auto const& e: view.vertexes[nodes_[v]].edges)
+			edges.emplace_back(v, ids[e.link->to]);
 	}
+	adjacency_ = empire::make_adjacency(nodes_.size(), edges);
 }
 
 template<typename T>
-std::size_t ColorNode<T>::hash() const
+void Simplifier<T>::simplify(int n)
 {
-	if (merged_)
+	auto const size = nodes_.size();
+	auto const capacity = size + size / 2 + 1;
+	size_t max_degree = 12;
+	for (size_t v = 0; v < size; ++v) max_degree = std::max(max_degree, adjacency_.degree(v));
+
+	offsets_ = adjacency_.offsets;
+	targets_ = adjacency_.targets;
+	offsets_.reserve(capacity + 1);
+	parent_.resize(size);
+	std::iota(std::begin(parent_), std::end(parent_), 0);
+	parent_.reserve(capacity);
+	degree_.assign(size, 0);
+	degree_.reserve(capacity);
+	marks_.assign(capacity, 0);
+	removed_.assign(size, false);
+	removed_.reserve(capacity);
+	buckets_ = empire::Buckets{capacity, max_degree + 1};
+
+	head_.resize(size);
+	std::iota(std::begin(head_), std::end(head_), 0);
+	tail_ = head_;
+	next_.assign(size, none);
+	merged_.clear();
+	base_.clear();
+	extracted_.clear();
+
+	for (size_t v = 0; v < size; ++v)
 	{
-		auto [k, m, n] = *merged_;
-		auto h = k.get().hash() ^ (m.get().hash() << 1);
-		return h ^ (n.get().hash() << 2);
+		degree_[v] = adjacency_.degree(v);
+		buckets_.push(v, degree_[v]);
 	}
-	return std::hash<T const*>{}(node);
-}
-
-template<typename T>
-class Simplifier
-{
-public:
-	using node_type = typename T::node_type;
-	using color_node_ref = typename ColorNode<node_type>::color_node_ref; // TODO - use const node_type
-	using ColorNodeRefList = std::list<color_node_ref>;
-
-	Simplifier(T& view);
-
-	void simplify(int n);
-	
-	ColorNodeRefList const& base() const { return base_; }
-	ColorNodeRefList const& extracted() const { return extracted_; }
-
-private:
-	ColorNodeRefList init();
-	bool extract(int limit, ColorNodeRefList& vertexes);
-	bool pack(ColorNodeRefList& vertexes);
-
-	void do_base(ColorNodeRefList& vertexes)
-	{ base_ = std::move(vertexes); }
-
-	ColorNodeRefList pull(int limit, ColorNodeRefList& vertexes) const;
-	void unbind(ColorNodeRefList const& vertexes) const;
 
-	void fold(ColorNodeRefList const& vertexes)
-	{ extracted_.insert(extracted_.begin(), vertexes.begin(), vertexes.end()); }
+	while (pull(n) || (n == 5 && pack()));
 
-	std::optional<Triple<color_node_ref>> pull_triple(ColorNodeRefList& vertexes) const;
-	color_node_ref merge(color_node_ref k, color_node_ref m, color_node_ref n);
-
-	std::vector<ColorNode<node_type>> color_nodes_; // TODO - use const node_type
-	ColorNodeRefList base_;
-	ColorNodeRefList extracted_;
-};
+	for (size_t v = 0; v < parent_.size(); ++v)
+		if (!removed_[v] && parent_[v] == v) base_.push_back(v);
+	std::reverse(std::begin(extracted_), std::end(extracted_));
+}
 
 template<typename T>
-Simplifier<T>::Simplifier(T& view)
+size_t Simplifier<T>::find(size_t v)
 {
-	color_nodes_.reserve(view.vertexes.size() * 2);
-
-	std::unordered_map<node_type const*, int> indexes;
-	int i = 0;
-	for (const auto& [node, _] : view.vertexes)
-	{
-		indexes.emplace(node, i++);
-		color_nodes_.emplace_back(node);
-	}
-
-	for (auto& cn: color_nodes_)
+	auto root = v;
+	while (parent_[root] != root) root = parent_[root];
+	while (parent_[v] != root)
 	{
-		auto const& edges = view.vertexes[cn.node].edges;
-		cn.neighbors.reserve(edges.size());
-		std::transform(
-			std::cbegin(edges),
-			std::cend(edges),
-			std::inserter(cn.neighbors, cn.neighbors.end()),
-			[this, &indexes](auto const& e) -> color_node_ref
-			{ return color_nodes_[indexes[e.link->to]]; });
+		auto const next = parent_[v];
+		parent_[v] = root;
+		v = next;
 	}
+	return root;
 }
 
 template<typename T>
-void Simplifier<T>::simplify(int n)
+template<typename F>
+void Simplifier<T>::for_each_neighbor(size_t v, F&& func)
 {
-	auto vertexes = init();
-
-	bool done = true;
-	int i = 0;
-	do
+	auto const stamp = ++stamp_;
+	for (auto e = offsets_[v]; e < offsets_[v + 1]; ++e)
 	{
-		done = !extract(n, vertexes);
-		if (done && n == 5)
-		{
-			done = !pack(vertexes);
-		}
-	} while (!done);
-
-	do_base(vertexes);
+		auto const u = find(targets_[e]);
+		if (u == v || removed_[u] || marks_[u] == stamp) continue;
+		marks_[u] = stamp;
+		func(u);
+	}
 }
 
 template<typename T>
-typename Simplifier<T>::ColorNodeRefList Simplifier<T>::init()
+bool Simplifier<T>::is_neighbor(size_t v, size_t u)
 {
-	base_.clear();
-	extracted_.clear();
-
-	ColorNodeRefList vertexes;
-	std::transform(
-		std::begin(color_nodes_),
-		std::end(color_nodes_),
-		std::back_inserter(vertexes),
-		[](auto& cn) -> color_node_ref { return cn; });
-
-	return vertexes;
+	bool found = false;
+	for_each_neighbor(v, [&found, u](size_t w) { found = found || w == u; });
+	return found;
 }
 
 template<typename T>
-bool Simplifier<T>::extract(int n, ColorNodeRefList& vertexes)
+void Simplifier<T>::remove(size_t v)
 {
-	auto extracted = pull(n, vertexes);
-	unbind(extracted);
-	fold(extracted);
-	return !extracted.empty();
+	removed_[v] = true;
+	buckets_.erase(v);
+	extracted_.push_back(v);
+	for_each_neighbor(v, [this](size_t u) { update(u, degree_[u] - 1); });
 }
 
 template<typename T>
-bool Simplifier<T>::pack(ColorNodeRefList& vertexes)
+bool Simplifier<T>::pull(int limit)
 {
-	if (auto triple = pull_triple(vertexes))
+	for (size_t degree = 1; degree < static_cast<size_t>(limit); ++degree)
 	{
-		auto [k, m, n] = *triple;
-		auto v = merge(k, m, n);
-		vertexes.push_back(v);
+		auto const v = buckets_.head(degree);
+		if (v == none) continue;
+		remove(v);
 		return true;
 	}
 	return false;
 }
 
 template<typename T>
-typename Simplifier<T>::ColorNodeRefList
-Simplifier<T>::pull(int limit, ColorNodeRefList& vertexes) const
+bool Simplifier<T>::pack()
 {
-	ColorNodeRefList extracted;
-	for (auto it = std::begin(vertexes); it != std::end(vertexes);)
+	for (auto k = buckets_.head(5); k != none; k = buckets_.next(k))
 	{
-		auto& v = it->get();
-		if (0 < v.neighbors.size() && v.neighbors.size() < limit)
+		Ids neighbors;
+		for_each_neighbor(k, [&neighbors](size_t u) { neighbors.push_back(u); });
+		for (auto m = std::begin(neighbors); m != std::end(neighbors); ++m)
 		{
-			extracted.emplace_front(v);
-			it = vertexes.erase(it);
+			if (degree_[*m] >= 8) continue;
+			for (auto n = std::next(m); n != std::end(neighbors); ++n)
+			{
+				if (degree_[*n] >= 8 || is_neighbor(*m, *n)) continue;
+				merge(k, *m, *n);
+				return true;
+			}
 		}
-		else ++it;
 	}
-
-	return extracted;
+	return false;
 }
 
 template<typename T>
-void Simplifier<T>::unbind(ColorNodeRefList const& vertexes) const
+void Simplifier<T>::merge(size_t k, size_t m, size_t n)
 {
-	for (auto const& v: vertexes)
-	{
-		for (auto& n: v.get().neighbors)
-		{
-			n.get().unbind(v);
-		}
-	}
-}
+	remove(k);
 
-template<typename T, typename U>
-std::optional<std::pair<T, T>>
-find_mn(U const& vertexes)
-{
-	for (auto m = std::cbegin(vertexes); m != std::cend(vertexes); ++m)
+	Ids neighbors;
+	auto const from_m = ++stamp_;
+	for (auto e = offsets_[m]; e < offsets_[m + 1]; ++e)
 	{
-		auto n = m;
-		std::advance(n, 1);
-		for (; n != std::cend(vertexes); ++n)
-		{
-			if (!m->get().is_neighbor(*n) &&
-				m->get().neighbors.size() < 8 &&
-				n->get().neighbors.size() < 8)
-			{
-				return std::make_pair(*m, *n);
-			}
-		}
+		auto const u = find(targets_[e]);
+		if (u == m || removed_[u] || marks_[u] == from_m) continue;
+		marks_[u] = from_m;
+		neighbors.push_back(u);
 	}
-	return {};
-}
-
-template<typename T>
-std::optional<Triple<typename Simplifier<T>::color_node_ref>>
-Simplifier<T>::pull_triple(ColorNodeRefList& vertexes) const
-{
-	for(auto k: vertexes)
+	auto const from_n = ++stamp_;
+	for (auto e = offsets_[n]; e < offsets_[n + 1]; ++e)
 	{
-		if (k.get().neighbors.size() != 5) continue;
-		if (auto mn = find_mn<color_node_ref>(k.get().neighbors))
-		{
-			vertexes.remove(k);
-			vertexes.remove(mn->first);
-			vertexes.remove(mn->second);
-			return Triple<color_node_ref>{k, mn->first, mn->second};
-		}
+		auto const u = find(targets_[e]);
+		if (u == n || removed_[u] || marks_[u] == from_n) continue;
+		if (marks_[u] == from_m) update(u, degree_[u] - 1);
+		else neighbors.push_back(u);
+		marks_[u] = from_n;
 	}
 
-	return {};
-}
-
-template<typename T>
-typename Simplifier<T>::color_node_ref Simplifier<T>::merge(
-	color_node_ref k,
-	color_node_ref m,
-	color_node_ref n)
-{
-	auto& v = color_nodes_.emplace_back(k, m, n);
-	k.get().unbind();
-	m.get().unbind();
-	n.get().unbind();
-	v.bind();
-	return v;
+	auto const v = parent_.size();
+	parent_.push_back(v);
+	parent_[m] = parent_[n] = v;
+	removed_.push_back(false);
+	buckets_.erase(m);
+	buckets_.erase(n);
+
+	targets_.insert(std::end(targets_), std::begin(neighbors), std::end(neighbors));
+	offsets_.push_back(targets_.size());
+	degree_.push_back(neighbors.size());
+	buckets_.push(v, neighbors.size());
+
+	head_.push_back(head_[m]);
+	tail_.push_back(tail_[n]);
+	next_[tail_[m]] = head_[n];
+	merged_.push_back({k, m, n});
 }
 
 } // namespace
@@ -338,19 +297,23 @@ public:
 	void paint_with(bwgui::Color const& color1, bwgui::Color const& color2, bwgui::Color const& color3, bwgui::Color const& color4);
 	void paint_with(bwgui::Color const& color1, bwgui::Color const& color2, bwgui::Color const& color3, bwgui::Color const& color4, bwgui::Color const& color5);
 	void paint_with(Colors const& colors);
+
+	template<typename F>
+	void paint_with(Colors const& colors, F&& engine);
 	
 private:
 	using vertex_type = typename T::vertex_type;
 	using node_type = typename T::node_type;
+	using Vertexes = std::vector<vertex_type*>;
 
-	bool has_colored_neighbour(::ColorNode<node_type> const& v, bwgui::Color const& color) const;
-	std::optional<bwgui::Color>
-	find_color(::ColorNode<node_type> const& v, Colors const& colors) const;
-	bool paint_one_with(::ColorNode<node_type> const& v, Colors const& colors);
+	Vertexes dense_vertexes();
+	Adjacency adjacency_of(Vertexes const& vertexes) const;
 
 	bool has_colored_neighbour(vertex_type const& v, bwgui::Color const& color) const;
 	bool paint_one_with(vertex_type& v, Colors const& colors);
 
+	bool paint_one_with(::Simplifier<T> const& simplifier, size_t v,
+		Colors const& colors, Coloring& coloring);
 	void paint_with(::Simplifier<T> simplifier, Colors const& colors);
 
 	T& view_;
@@ -387,66 +350,53 @@ bool Colorizer<T>::paint_one_with(vertex_type& v, Colors const& colors)
 }
 
 template<typename T>
-bool Colorizer<T>::has_colored_neighbour(::ColorNode<node_type> const& v, bwgui::Color const& color) const
+bool Colorizer<T>::paint_one_with(::Simplifier<T> const& simplifier, size_t v,
+	Colors const& colors, Coloring& coloring)
 {
-	for (auto const& n: v.neighbors)
+	auto const& adjacency = simplifier.adjacency();
+	std::vector<bool> used(colors.size(), false);
+	simplifier.for_each_member(v, [&adjacency, &coloring, &used](size_t m)
 	{
-		if (n.get().is_packed()) continue;
-		auto const& neighbour = view_.vertexes[n.get().node];
-		if (neighbour.style.background == color)
+		for (auto e = adjacency.offsets[m]; e < adjacency.offsets[m + 1]; ++e)
 		{
-			return true;
+			auto const color = coloring[adjacency.targets[e]];
+			if (color != NoColor) used[color] = true;
 		}
-	}
-	return false;
-}
+	});
 
-template<typename T>
-std::optional<bwgui::Color> 
-Colorizer<T>::find_color(::ColorNode<node_type> const& v, Colors const& colors) const
-{
-	for (auto const& color: colors)
+	auto const color = std::find(std::begin(used), std::end(used), false) - std::begin(used);
+	if (static_cast<size_t>(color) == used.size())
 	{
-		if (!has_colored_neighbour(v, color))
-		{
-			return color;
-		}
+		simplifier.for_each_member(v, [this, &simplifier](size_t m)
+			{ print_error(view_.vertexes[simplifier.node(m)]); });
+		return false;
 	}
-	return {};
-}
 
-template<typename T>
-bool Colorizer<T>::paint_one_with(::ColorNode<node_type> const& v, Colors const& colors)
-{
-	if (v.is_packed())
+	simplifier.for_each_member(v, [this, &simplifier, &colors, &coloring, color](size_t m)
 	{
-		if (auto color = find_color(v, colors))
-		{
-			auto [k, m, n] = v.unpack();
-			view_.vertexes[m.get().node].style.background = *color;
-			view_.vertexes[n.get().node].style.background = *color;
-			return paint_one_with(view_.vertexes[k.get().node], colors);
-		}
-		return false;
-	}
-	auto& vertex = view_.vertexes[v.node];
-	return paint_one_with(vertex, colors);
+		coloring[m] = color;
+		auto& vertex = view_.vertexes[simplifier.node(m)];
+		vertex.style.background = colors[color];
+		print_colored(vertex);
+	});
+	return true;
 }
 
 template<typename T>
 void Colorizer<T>::paint_with(::Simplifier<T> simplifier, Colors const& colors)
 {
 	simplifier.simplify(colors.size());
+	Coloring coloring(simplifier.size(), NoColor);
 
 	for (auto v: simplifier.base())
 	{
-		auto const ok = paint_one_with(v.get(), colors);
+		auto const ok = paint_one_with(simplifier, v, colors, coloring);
 		if (!ok) return;
 	}
 
 	for (auto v: simplifier.extracted())
 	{
-		auto const ok = paint_one_with(v.get(), colors);
+		auto const ok = paint_one_with(simplifier, v, colors, coloring);
 		if (!ok) return;
 	}
 }
@@ -460,42 +410,20 @@ void Colorizer<T>::paint_with(bwgui::Color const& color1)
 template<typename T>
 void Colorizer<T>::paint_with(bwgui::Color const& color1, bwgui::Color const& color2)
 {
-	if (view_.vertexes.empty()) return;
-
-	auto& [n, v] = *view_.vertexes.begin();
-	v.style.background = color1;
-	print_colored(v);
-
-	std::queue<vertex_type const*> colored;
-	colored.push(&v);
-	
-	while (!colored.empty())
+	auto const vertexes = dense_vertexes();
+	auto const bipartition = parallel_bipartition(adjacency_of(vertexes));
+	if (!bipartition.is_bipartite())
 	{
-		auto v = colored.front();
-		colored.pop();
-		
-		auto const& color = v->style.background == color1 ? color2 : color1;
+		std::cerr << "Impossible to color, odd cycle:";
+		for (auto v: bipartition.odd_cycle) std::cerr << ' ' << vertexes[v]->node->value;
+		std::cerr << std::endl;
+		return;
+	}
 
-		for (auto const& e: v->edges)
-		{
-			auto& to = view_.vertexes[e.link->to];
-			if (to.style.background == v->style.background)
-			{
-				std::cerr << "Impossible to color: " << v->node->value << " and " << to.node->value << " have the same color" << std::endl;
-				
-				return;
-			}
-			if (to.style.background == color)
-			{
-				// already colored right
-			}
-			else
-			{
-				to.style.background = color;
-				colored.push(&to);
-				print_colored(to);
-			}
-		}
+	for (size_t i = 0; i < vertexes.size(); ++i)
+	{
+		vertexes[i]->style.background = bipartition.sides[i] == 0 ? color1 : color2;
+		print_colored(*vertexes[i]);
 	}
 }
 
@@ -539,6 +467,48 @@ void Colorizer<T>::paint_with(Colors const& colors)
 	}
 }
 
+template<typename T>
+template<typename F>
+void Colorizer<T>::paint_with(Colors const& colors, F&& engine)
+{
+	auto const vertexes = dense_vertexes();
+	auto const coloring = engine(adjacency_of(vertexes));
+	for (size_t i = 0; i < vertexes.size(); ++i)
+	{
+		if (coloring[i] == NoColor || coloring[i] >= static_cast<int>(colors.size()))
+		{
+			print_error(*vertexes[i]);
+			return;
+		}
+		vertexes[i]->style.background = colors[coloring[i]];
+		print_colored(*vertexes[i]);
+	}
+}
+
+template<typename T>
+typename Colorizer<T>::Vertexes Colorizer<T>::dense_vertexes()
+{
+	Vertexes vertexes;
+	vertexes.reserve(view_.vertexes.size());
+	for (auto& [n, v]: view_.vertexes) vertexes.push_back(&v);
+	return vertexes;
+}
+
+template<typename T>
+Adjacency Colorizer<T>::adjacency_of(Vertexes const& vertexes) const
+{
+	std::unordered_map<node_type const*, size_t> ids;
+	ids.reserve(vertexes.size());
+	for (size_t i = 0; i < vertexes.size(); ++i) ids.emplace(vertexes[i]->node, i);
+
+	Edges edges;
+	for (size_t i = 0; i < vertexes.size(); ++i)
+	{
+		for (auto const& e: vertexes[i]->edges) edges.emplace_back(i, ids.at(e.link->to));
+	}
+	return make_adjacency(vertexes.size(), edges);
+}
+
 } // namespace empire
 
 #endif // _COLORIZER_H_
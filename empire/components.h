@@ -0,0 +1,276 @@
+﻿#ifndef _COMPONENTS_H_
+#define _COMPONENTS_H_
+
+#include "csr.h"
+
+#include "../core/parallel.h"
+
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace empire
+{
+
+// Union-find with path halving and union by size
+class UnionFind
+{
+public:
+	explicit UnionFind(size_t n): parent_(n), size_(n, 1)
+	{
+		std::iota(std::begin(parent_), std::end(parent_), 0);
+	}
+
+	size_t size() const { return parent_.size(); }
+
+	size_t find(size_t v)
+	{
+		while (parent_[v] != v)
+		{
+			parent_[v] = parent_[parent_[v]];
+			v = parent_[v];
+		}
+		return v;
+	}
+
+	bool unite(size_t a, size_t b)
+	{
+		a = find(a);
+		b = find(b);
+		if (a == b) return false;
+		if (size_[a] < size_[b]) std::swap(a, b);
+		parent_[b] = a;
+		size_[a] += size_[b];
+		return true;
+	}
+
+private:
+	std::vector<size_t> parent_;
+	std::vector<size_t> size_;
+};
+
+// Union-find safe for concurrent unite and find, roots are linked
+// from the larger id to the smaller one so a root is the smallest
+// vertex of its set and paths are halved with compare-exchange
+class ConcurrentUnionFind
+{
+public:
+	explicit ConcurrentUnionFind(size_t n): parent_(n)
+	{
+		for (size_t v = 0; v < n; ++v) parent_[v].store(v, std::memory_order_relaxed);
+	}
+
+	size_t size() const { return parent_.size(); }
+
+	size_t find(size_t v)
+	{
+		while (true)
+		{
+			auto p = parent_[v].load(std::memory_order_acquire);
+			if (p == v) return v;
+			auto const grand = parent_[p].load(std::memory_order_acquire);
+			if (p != grand) parent_[v].compare_exchange_weak(p, grand, std::memory_order_acq_rel);
+			v = grand;
+		}
+	}
+
+	bool unite(size_t a, size_t b)
+	{
+		while (true)
+		{
+			a = find(a);
+			b = find(b);
+			if (a == b) return false;
+			if (a < b) std::swap(a, b);
+			auto expected = a;
+			if (parent_[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) return true;
+		}
+	}
+
+private:
+	std::vector<std::atomic<size_t>> parent_;
+};
+
+struct Components
+{
+	std::vector<size_t> ids;
+	size_t count{0};
+};
+
+namespace
+{
+
+// Roots are the smallest vertexes of their components,
+// they get dense ids in the order of the vertexes
+Components dense_components(std::vector<size_t> roots)
+{
+	Components components;
+	components.ids = std::move(roots);
+	for (size_t v = 0; v < components.ids.size(); ++v)
+	{
+		auto const root = components.ids[v];
+		components.ids[v] = root == v ? components.count++ : components.ids[root];
+	}
+	return components;
+}
+
+// Rows are Adjacency or Csr, links are taken as undirected and
+// symmetric rows are united from one end only
+template<typename R>
+Components union_find_components(R const& rows, bool symmetric, unsigned threads)
+{
+	auto const n = rows.size();
+	ConcurrentUnionFind sets{n};
+	core::parallel_for(0, n,
+		[&rows, &sets, symmetric](size_t v)
+		{
+			for (auto e = rows.offsets[v]; e < rows.offsets[v + 1]; ++e)
+			{
+				auto const u = rows.targets[e];
+				if (!symmetric || u < v) sets.unite(v, u);
+			}
+		},
+		threads);
+
+	std::vector<size_t> roots(n);
+	core::parallel_for(0, n, [&roots, &sets](size_t v) { roots[v] = sets.find(v); }, threads);
+	return dense_components(std::move(roots));
+}
+
+// Afforest: links a few sampled neighbours of every vertex, guesses the
+// largest component from a sample of parents and then links the rest of
+// the edges only outside of it. Hooking goes from the larger root to the
+// smaller one with compare-exchange, compression is pointer jumping
+// like in Shiloach-Vishkin. On symmetric rows the vertexes of the largest
+// component are skipped at all, otherwise only their links into it are
+template<typename R>
+Components afforest(R const& rows, bool symmetric, unsigned threads, size_t rounds)
+{
+	auto const n = rows.size();
+	std::vector<std::atomic<size_t>> parents(n);
+	for (size_t v = 0; v < n; ++v) parents[v].store(v, std::memory_order_relaxed);
+	auto parent = [&parents](size_t v) { return parents[v].load(std::memory_order_relaxed); };
+
+	auto link = [&parents, &parent](size_t u, size_t v)
+	{
+		auto p1 = parent(u);
+		auto p2 = parent(v);
+		while (p1 != p2)
+		{
+			auto const high = std::max(p1, p2);
+			auto const low = std::min(p1, p2);
+			auto const p_high = parent(high);
+			if (p_high == low) break;
+			auto expected = high;
+			if (p_high == high && parents[high].compare_exchange_strong(expected, low)) break;
+			p1 = parent(parent(high));
+			p2 = parent(low);
+		}
+	};
+
+	auto compress = [&]
+	{
+		core::parallel_for(0, n,
+			[&parents, &parent](size_t v)
+			{
+				while (parent(v) != parent(parent(v)))
+					parents[v].store(parent(parent(v)), std::memory_order_relaxed);
+			},
+			threads);
+	};
+
+	for (size_t r = 0; r < rounds; ++r)
+	{
+		core::parallel_for(0, n,
+			[&rows, &link, r](size_t v)
+			{
+				if (r < rows.offsets[v + 1] - rows.offsets[v]) link(v, rows.targets[rows.offsets[v] + r]);
+			},
+			threads);
+		compress();
+	}
+
+	size_t largest = 0;
+	if (n > 0)
+	{
+		std::unordered_map<size_t, size_t> counts;
+		std::default_random_engine engine{0};
+		std::uniform_int_distribution<size_t> random{0, n - 1};
+		size_t best = 0;
+		for (int i = 0; i < 1024; ++i)
+		{
+			auto const c = parent(random(engine));
+			if (++counts[c] > best)
+			{
+				best = counts[c];
+				largest = c;
+			}
+		}
+	}
+
+	core::parallel_for(0, n,
+		[&](size_t v)
+		{
+			auto const inside = parent(v) == largest;
+			if (inside && symmetric) return;
+			auto const first = std::min(rows.offsets[v] + rounds, rows.offsets[v + 1]);
+			for (auto e = inside ? rows.offsets[v] : first; e < rows.offsets[v + 1]; ++e)
+			{
+				auto const u = rows.targets[e];
+				if (!inside || parent(u) != largest) link(v, u);
+			}
+		},
+		threads);
+	compress();
+
+	std::vector<size_t> roots(n);
+	for (size_t v = 0; v < n; ++v) roots[v] = parent(v);
+	return dense_components(std::move(roots));
+}
+
+} // namespace
+
+// Dense component ids ordered by the smallest vertex of every component,
+// links of a Csr and of a Graph are taken as undirected
+Components connected_components(Adjacency const& adjacency, unsigned threads = core::concurrency())
+{
+	return union_find_components(adjacency, true, threads);
+}
+
+template<typename T>
+Components connected_components(Csr<T> const& csr, unsigned threads = core::concurrency())
+{
+	return union_find_components(csr, false, threads);
+}
+
+template<typename T, typename U>
+Components connected_components(Graph<T, U> const& graph, unsigned threads = core::concurrency())
+{
+	return union_find_components(make_csr(graph), false, threads);
+}
+
+Components afforest_components(Adjacency const& adjacency,
+	unsigned threads = core::concurrency(), size_t rounds = 2)
+{
+	return afforest(adjacency, true, threads, rounds);
+}
+
+template<typename T>
+Components afforest_components(Csr<T> const& csr,
+	unsigned threads = core::concurrency(), size_t rounds = 2)
+{
+	return afforest(csr, false, threads, rounds);
+}
+
+template<typename T, typename U>
+Components afforest_components(Graph<T, U> const& graph,
+	unsigned threads = core::concurrency(), size_t rounds = 2)
+{
+	return afforest(make_csr(graph), false, threads, rounds);
+}
+
+} // namespace empire
+
+#endif // _COMPONENTS_H_
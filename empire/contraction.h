@@ -0,0 +1,464 @@
+﻿#ifndef _CONTRACTION_H_
+#define _CONTRACTION_H_
+
+#include "csr.h"
+#include "dijkstra.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace empire
+{
+
+// Contraction hierarchy: nodes are contracted in the order of their edge
+// difference, a shortcut replaces the two arcs through the contracted node
+// unless a witness search finds a path not longer than them. Queries are
+// bidirectional Dijkstra searches going only up in the order, found arcs
+// are unpacked back into links of the graph
+template<typename T>
+class ContractionHierarchy
+{
+public:
+	using node_type = typename T::node_type;
+	using link_type = typename T::link_type;
+	using cost_type = typename link_type::cost_type;
+
+	explicit ContractionHierarchy(T const& graph, size_t witness_limit = 500);
+	ContractionHierarchy(T const& graph, std::istream& in);
+
+	std::vector<link_type*> find_path(node_type const* from, node_type const* to);
+
+	size_t size() const { return ranks_.size(); }
+	size_t arcs() const { return arcs_.size(); }
+	size_t shortcuts() const { return arcs_.size() - originals_; }
+	size_t rank(node_type const* node) const { return ranks_[csr_.id(node)]; }
+
+	void save(std::ostream& out) const;
+
+private:
+	struct Arc
+	{
+		size_t from;
+		size_t to;
+		cost_type cost;
+		size_t first;
+		size_t second;
+
+		bool is_shortcut() const { return second != NoLink; }
+	};
+
+	using Ids = std::vector<size_t>;
+
+	void contract(size_t witness_limit);
+	int shortcuts_of(size_t v, size_t witness_limit, bool insert);
+	void witness_search(size_t source, size_t skipped, cost_type limit, size_t witness_limit);
+	void build_search_graph();
+	void unpack(size_t arc, std::vector<link_type*>& path) const;
+
+	Csr<T> csr_;
+	std::vector<Arc> arcs_;
+	size_t originals_{0};
+	std::vector<size_t> ranks_;
+
+	std::vector<Ids> out_;
+	std::vector<Ids> in_;
+	std::vector<bool> contracted_;
+
+	std::vector<size_t> up_offsets_;
+	Ids up_arcs_;
+	std::vector<size_t> down_offsets_;
+	Ids down_arcs_;
+
+	std::vector<cost_type> distances_[2];
+	std::vector<size_t> parents_[2];
+	Ids touched_[2];
+};
+
+template<typename T>
+ContractionHierarchy<T>::ContractionHierarchy(T const& graph, size_t witness_limit): csr_{make_csr(graph)}
+{
+	auto const n = csr_.size();
+	out_.resize(n);
+	in_.resize(n);
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (auto e = csr_.offsets[v]; e < csr_.offsets[v + 1]; ++e)
+		{
+			if (csr_.targets[e] == v) continue;
+			arcs_.push_back({v, csr_.targets[e], csr_.links[e]->cost, e, NoLink});
+			out_[v].push_back(arcs_.size() - 1);
+			in_[csr_.targets[e]].push_back(arcs_.size() - 1);
+		}
+	}
+	originals_ = arcs_.size();
+
+	contract(witness_limit);
+	build_search_graph();
+}
+
+// Dijkstra from the source around the skipped node, stopped by the cost
+// limit or by the number of settled nodes
+template<typename T>
+void ContractionHierarchy<T>::witness_search(size_t source, size_t skipped, cost_type limit, size_t witness_limit)
+{
+	auto& distances = distances_[0];
+	for (auto v: touched_[0]) distances[v] = unreachable<cost_type>();
+	touched_[0].clear();
+
+	using Item = std::pair<cost_type, size_t>;
+	std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+	distances[source] = cost_type{};
+	touched_[0].push_back(source);
+	heap.push({cost_type{}, source});
+	for (size_t settled = 0; !heap.empty() && settled < witness_limit; ++settled)
+	{
+		auto const [distance, v] = heap.top();
+		heap.pop();
+		if (distance != distances[v]) continue;
+		if (limit < distance) break;
+		for (auto a: out_[v])
+		{
+			auto const& arc = arcs_[a];
+			if (contracted_[arc.to] || arc.to == skipped) continue;
+			auto const candidate = distance + arc.cost;
+			if (!(candidate < distances[arc.to])) continue;
+			if (distances[arc.to] == unreachable<cost_type>()) touched_[0].push_back(arc.to);
+			distances[arc.to] = candidate;
+			heap.push({candidate, arc.to});
+		}
+	}
+}
+
+// Counts or inserts the shortcuts needed to contract v
+template<typename T>
+int ContractionHierarchy<T>::shortcuts_of(size_t v, size_t witness_limit, bool insert)
+{
+	int count = 0;
+	auto const incoming = in_[v];
+	for (auto a: incoming)
+	{
+		auto const u = arcs_[a].from;
+		if (contracted_[u]) continue;
+
+		auto limit = cost_type{};
+		bool any = false;
+		for (auto b: out_[v])
+		{
+			auto const w = arcs_[b].to;
+			if (contracted_[w] || w == u) continue;
+			auto const through = arcs_[a].cost + arcs_[b].cost;
+			limit = any ? std::max(limit, through) : through;
+			any = true;
+		}
+		if (!any) continue;
+
+		witness_search(u, v, limit, witness_limit);
+		auto const outgoing = out_[v];
+		for (auto b: outgoing)
+		{
+			auto const w = arcs_[b].to;
+			if (contracted_[w] || w == u) continue;
+			auto const through = arcs_[a].cost + arcs_[b].cost;
+			if (!(through < distances_[0][w])) continue;
+			++count;
+			if (!insert) continue;
+			arcs_.push_back({u, w, through, a, b});
+			out_[u].push_back(arcs_.size() - 1);
+			in_[w].push_back(arcs_.size() - 1);
+		}
+	}
+	return count;
+}
+
+template<typename T>
+void ContractionHierarchy<T>::contract(size_t witness_limit)
+{
+	auto const n = csr_.size();
+	contracted_.assign(n, false);
+	ranks_.assign(n, 0);
+	distances_[0].assign(n, unreachable<cost_type>());
+	std::vector<int> neighbours(n, 0);
+
+	auto priority = [&](size_t v)
+	{
+		int degree = 0;
+		for (auto a: in_[v]) degree += !contracted_[arcs_[a].from];
+		for (auto a: out_[v]) degree += !contracted_[arcs_[a].to];
+		return shortcuts_of(v, witness_limit, false) - degree + neighbours[v];
+	};
+
+	using Item = std::pair<int, size_t>;
+	std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+	for (size_t v = 0; v < n; ++v) queue.push({priority(v), v});
+
+	for (size_t rank = 0; !queue.empty();)
+	{
+		auto const v = queue.top().second;
+		queue.pop();
+		if (contracted_[v]) continue;
+
+		// Lazy update: the stored priority may be too low by now
+		auto const current = priority(v);
+		if (!queue.empty() && current > queue.top().first)
+		{
+			queue.push({current, v});
+			continue;
+		}
+
+		shortcuts_of(v, witness_limit, true);
+		contracted_[v] = true;
+		ranks_[v] = rank++;
+		for (auto a: in_[v]) ++neighbours[arcs_[a].from];
+		for (auto a: out_[v]) ++neighbours[arcs_[a].to];
+	}
+
+	std::vector<Ids>().swap(out_);
+	std::vector<Ids>().swap(in_);
+	std::vector<bool>().swap(contracted_);
+}
+
+// Upward arcs are kept at their lower end: the forward search follows
+// arcs to higher nodes, the backward one follows them in reverse
+template<typename T>
+void ContractionHierarchy<T>::build_search_graph()
+{
+	auto const n = ranks_.size();
+	up_offsets_.assign(n + 1, 0);
+	down_offsets_.assign(n + 1, 0);
+	for (auto const& arc: arcs_)
+	{
+		if (ranks_[arc.from] < ranks_[arc.to]) ++up_offsets_[arc.from + 1];
+		else ++down_offsets_[arc.to + 1];
+	}
+	for (size_t v = 0; v < n; ++v)
+	{
+		up_offsets_[v + 1] += up_offsets_[v];
+		down_offsets_[v + 1] += down_offsets_[v];
+	}
+
+	up_arcs_.resize(up_offsets_.back());
+	down_arcs_.resize(down_offsets_.back());
+	auto up = up_offsets_;
+	auto down = down_offsets_;
+	for (size_t a = 0; a < arcs_.size(); ++a)
+	{
+		auto const& arc = arcs_[a];
+		if (ranks_[arc.from] < ranks_[arc.to]) up_arcs_[up[arc.from]++] = a;
+		else down_arcs_[down[arc.to]++] = a;
+	}
+
+	for (auto side: {0, 1})
+	{
+		distances_[side].assign(n, unreachable<cost_type>());
+		parents_[side].assign(n, NoLink);
+		touched_[side].clear();
+	}
+}
+
+template<typename T>
+std::vector<typename ContractionHierarchy<T>::link_type*>
+ContractionHierarchy<T>::find_path(node_type const* from, node_type const* to)
+{
+	auto const s = csr_.id(from);
+	auto const t = csr_.id(to);
+	std::vector<link_type*> path;
+	if (s == t) return path;
+
+	for (auto side: {0, 1})
+	{
+		for (auto v: touched_[side])
+		{
+			distances_[side][v] = unreachable<cost_type>();
+			parents_[side][v] = NoLink;
+		}
+		touched_[side].clear();
+	}
+
+	using Item = std::pair<cost_type, size_t>;
+	using Heap = std::priority_queue<Item, std::vector<Item>, std::greater<Item>>;
+	Heap heaps[2];
+	size_t const sources[2]{s, t};
+	for (auto side: {0, 1})
+	{
+		distances_[side][sources[side]] = cost_type{};
+		touched_[side].push_back(sources[side]);
+		heaps[side].push({cost_type{}, sources[side]});
+	}
+
+	auto best = unreachable<cost_type>();
+	auto meeting = NoLink;
+	while (!heaps[0].empty() || !heaps[1].empty())
+	{
+		auto const side = heaps[1].empty() ||
+			(!heaps[0].empty() && heaps[0].top().first < heaps[1].top().first) ? 0 : 1;
+		auto const [distance, v] = heaps[side].top();
+		heaps[side].pop();
+		if (!(distance < best)) break;
+		if (distance != distances_[side][v]) continue;
+
+		if (distances_[1 - side][v] != unreachable<cost_type>() &&
+			distance + distances_[1 - side][v] < best)
+		{
+			best = distance + distances_[1 - side][v];
+			meeting = v;
+		}
+
+		auto const& offsets = side == 0 ? up_offsets_ : down_offsets_;
+		auto const& arcs = side == 0 ? up_arcs_ : down_arcs_;
+		for (auto i = offsets[v]; i < offsets[v + 1]; ++i)
+		{
+			auto const& arc = arcs_[arcs[i]];
+			auto const u = side == 0 ? arc.to : arc.from;
+			auto const candidate = distance + arc.cost;
+			if (!(candidate < distances_[side][u])) continue;
+			if (distances_[side][u] == unreachable<cost_type>()) touched_[side].push_back(u);
+			distances_[side][u] = candidate;
+			parents_[side][u] = arcs[i];
+			heaps[side].push({candidate, u});
+		}
+	}
+	if (meeting == NoLink) return path;
+
+	std::vector<size_t> chain;
+	for (auto v = meeting; v != s; v = arcs_[parents_[0][v]].from) chain.push_back(parents_[0][v]);
+	std::reverse(std::begin(chain), std::end(chain));
+	for (auto v = meeting; v != t; v = arcs_[parents_[1][v]].to) chain.push_back(parents_[1][v]);
+	for (auto a: chain) unpack(a, path);
+	return path;
+}
+
+template<typename T>
+void ContractionHierarchy<T>::unpack(size_t arc, std::vector<link_type*>& path) const
+{
+	std::vector<size_t> stack{arc};
+	while (!stack.empty())
+	{
+		auto const& a = arcs_[stack.back()];
+		stack.pop_back();
+		if (!a.is_shortcut())
+		{
+			path.push_back(csr_.links[a.first]);
+			continue;
+		}
+		stack.push_back(a.second);
+		stack.push_back(a.first);
+	}
+}
+
+// Binary format in native byte order: magic, version, cost size, node,
+// link and arc counts, node ranks and arcs as from, to, cost, first, second
+namespace
+{
+
+constexpr char HierarchyMagic[4]{'E', 'M', 'C', 'H'};
+constexpr uint32_t HierarchyVersion = 1;
+
+template<typename V>
+void write_value(std::ostream& out, V const& value)
+{
+	out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+template<typename V>
+V read_value(std::istream& in)
+{
+	V value;
+	in.read(reinterpret_cast<char*>(&value), sizeof(value));
+	if (!in) throw std::runtime_error{"truncated hierarchy"};
+	return value;
+}
+
+} // namespace
+
+template<typename T>
+void ContractionHierarchy<T>::save(std::ostream& out) const
+{
+	static_assert(std::is_trivially_copyable_v<cost_type>, "only trivially copyable costs can be stored");
+	out.write(HierarchyMagic, sizeof(HierarchyMagic));
+	write_value(out, HierarchyVersion);
+	write_value(out, static_cast<uint32_t>(sizeof(cost_type)));
+	write_value(out, static_cast<uint64_t>(ranks_.size()));
+	write_value(out, static_cast<uint64_t>(csr_.edges()));
+	write_value(out, static_cast<uint64_t>(arcs_.size()));
+	write_value(out, static_cast<uint64_t>(originals_));
+	for (auto r: ranks_) write_value(out, static_cast<uint64_t>(r));
+	for (auto const& arc: arcs_)
+	{
+		write_value(out, static_cast<uint64_t>(arc.from));
+		write_value(out, static_cast<uint64_t>(arc.to));
+		write_value(out, arc.cost);
+		write_value(out, static_cast<uint64_t>(arc.first));
+		write_value(out, static_cast<uint64_t>(arc.second));
+	}
+}
+
+// The graph has to be the one the hierarchy was built from
+template<typename T>
+ContractionHierarchy<T>::ContractionHierarchy(T const& graph, std::istream& in): csr_{make_csr(graph)}
+{
+	char magic[4];
+	in.read(magic, sizeof(magic));
+	if (!in || std::memcmp(magic, HierarchyMagic, sizeof(magic)) != 0) throw std::runtime_error{"not a hierarchy"};
+	if (read_value<uint32_t>(in) != HierarchyVersion) throw std::runtime_error{"unsupported hierarchy version"};
+	if (read_value<uint32_t>(in) != sizeof(cost_type)) throw std::runtime_error{"hierarchy cost type mismatch"};
+	if (read_value<uint64_t>(in) != csr_.size() || read_value<uint64_t>(in) != csr_.edges())
+		throw std::runtime_error{"hierarchy of another graph"};
+
+	auto const n = csr_.size();
+	auto const arcs = read_value<uint64_t>(in);
+	originals_ = read_value<uint64_t>(in);
+	if (originals_ > arcs || originals_ > csr_.edges()) throw std::runtime_error{"corrupt hierarchy arcs"};
+
+	// A seekable stream has to hold every rank and arc, otherwise the
+	// arcs are read one by one and a short stream stops them
+	auto const arc_size = 4 * sizeof(uint64_t) + sizeof(cost_type);
+	auto const start = in.tellg();
+	if (start != std::istream::pos_type(-1) && in.seekg(0, std::ios::end))
+	{
+		auto const available = static_cast<uint64_t>(in.tellg() - start);
+		in.seekg(start);
+		if (available / sizeof(uint64_t) < n || (available - n * sizeof(uint64_t)) / arc_size < arcs)
+			throw std::runtime_error{"truncated hierarchy"};
+		arcs_.reserve(arcs);
+	}
+	in.clear();
+
+	ranks_.resize(n);
+	for (auto& r: ranks_)
+	{
+		r = read_value<uint64_t>(in);
+		if (r >= n) throw std::runtime_error{"corrupt hierarchy ranks"};
+	}
+
+	// Original arcs come first and name a link, a shortcut is made of two
+	// arcs stored before it, so unpacking always ends
+	for (uint64_t a = 0; a < arcs; ++a)
+	{
+		Arc arc;
+		arc.from = read_value<uint64_t>(in);
+		arc.to = read_value<uint64_t>(in);
+		arc.cost = read_value<cost_type>(in);
+		arc.first = read_value<uint64_t>(in);
+		arc.second = read_value<uint64_t>(in);
+		bool const valid = arc.from < n && arc.to < n && (a < originals_
+			? arc.second == NoLink && arc.first < csr_.edges()
+			: arc.first < a && arc.second < a);
+		if (!valid) throw std::runtime_error{"corrupt hierarchy arcs"};
+		arcs_.push_back(arc);
+	}
+	if (!in) throw std::runtime_error{"truncated hierarchy"};
+	build_search_graph();
+}
+
+} // namespace empire
+
+#endif // _CONTRACTION_H_
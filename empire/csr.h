@@ -0,0 +1,168 @@
+﻿#ifndef _CSR_H_
+#define _CSR_H_
+
+#include "graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace empire
+{
+
+constexpr size_t NoLink = std::numeric_limits<size_t>::max();
+
+template<typename T>
+struct Csr
+{
+	using node_type = typename T::node_type;
+	using link_type = typename T::link_type;
+	using cost_type = typename link_type::cost_type;
+
+	std::vector<node_type*> nodes;
+	std::vector<size_t> offsets;
+	std::vector<size_t> targets;
+	std::vector<link_type*> links;
+	std::unordered_map<node_type const*, size_t> ids;
+
+	size_t size() const { return nodes.size(); }
+	size_t edges() const { return targets.size(); }
+	size_t degree(size_t v) const { return offsets[v + 1] - offsets[v]; }
+	size_t id(node_type const* node) const { return ids.at(node); }
+};
+
+template<typename T>
+Csr<T> make_csr(T const& graph)
+{
+	Csr<T> csr;
+	auto const n = graph.size();
+	csr.nodes.reserve(n);
+	csr.ids.reserve(n);
+	csr.offsets.reserve(n + 1);
+
+	size_t m = 0;
+	for (auto const& node: graph)
+	{
+		csr.ids.emplace(node.get(), csr.nodes.size());
+		csr.nodes.push_back(node.get());
+		m += node->links.size();
+	}
+
+	csr.targets.reserve(m);
+	csr.links.reserve(m);
+	csr.offsets.push_back(0);
+	for (auto node: csr.nodes)
+	{
+		for (auto& l: node->links)
+		{
+			csr.targets.push_back(csr.ids[l.to]);
+			csr.links.push_back(&l);
+		}
+		csr.offsets.push_back(csr.targets.size());
+	}
+	return csr;
+}
+
+struct Adjacency
+{
+	std::vector<size_t> offsets;
+	std::vector<size_t> targets;
+
+	size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	size_t edges() const { return targets.size(); }
+	size_t degree(size_t v) const { return offsets[v + 1] - offsets[v]; }
+};
+
+using Edges = std::vector<std::pair<size_t, size_t>>;
+
+// Undirected adjacency without loops and duplicated edges
+Adjacency make_adjacency(size_t n, Edges const& edges)
+{
+	Adjacency adjacency;
+	adjacency.offsets.assign(n + 1, 0);
+	for (auto [from, to]: edges)
+	{
+		if (from == to) continue;
+		++adjacency.offsets[from + 1];
+		++adjacency.offsets[to + 1];
+	}
+	for (size_t v = 0; v < n; ++v) adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+	std::vector<size_t> tails(std::begin(adjacency.offsets), std::end(adjacency.offsets) - 1);
+	adjacency.targets.resize(adjacency.offsets.back());
+	for (auto [from, to]: edges)
+	{
+		if (from == to) continue;
+		adjacency.targets[tails[from]++] = to;
+		adjacency.targets[tails[to]++] = from;
+	}
+
+	size_t tail = 0;
+	for (size_t v = 0; v < n; ++v)
+	{
+		auto const first = std::begin(adjacency.targets) + adjacency.offsets[v];
+		auto const last = std::begin(adjacency.targets) + adjacency.offsets[v + 1];
+		std::sort(first, last);
+		auto const unique = std::unique(first, last);
+		adjacency.offsets[v] = tail;
+		for (auto it = first; it != unique; ++it) adjacency.targets[tail++] = *it;
+	}
+	adjacency.offsets[n] = tail;
+	adjacency.targets.resize(tail);
+	return adjacency;
+}
+
+template<typename T>
+Adjacency make_adjacency(Csr<T> const& csr)
+{
+	Edges edges;
+	edges.reserve(csr.edges());
+	for (size_t v = 0; v < csr.size(); ++v)
+	{
+		for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+			edges.emplace_back(v, csr.targets[e]);
+	}
+	return make_adjacency(csr.size(), edges);
+}
+
+// Incoming links, targets of row v are the sources of the links into v
+// and links keep the index of the link in the Csr
+struct Transposed
+{
+	std::vector<size_t> offsets;
+	std::vector<size_t> sources;
+	std::vector<size_t> links;
+
+	size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	size_t degree(size_t v) const { return offsets[v + 1] - offsets[v]; }
+};
+
+template<typename T>
+Transposed make_transposed(Csr<T> const& csr)
+{
+	auto const n = csr.size();
+	Transposed transposed;
+	transposed.offsets.assign(n + 1, 0);
+	for (auto t: csr.targets) ++transposed.offsets[t + 1];
+	for (size_t v = 0; v < n; ++v) transposed.offsets[v + 1] += transposed.offsets[v];
+
+	std::vector<size_t> tails(std::begin(transposed.offsets), std::end(transposed.offsets) - 1);
+	transposed.sources.resize(csr.edges());
+	transposed.links.resize(csr.edges());
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+		{
+			auto const i = tails[csr.targets[e]]++;
+			transposed.sources[i] = v;
+			transposed.links[i] = e;
+		}
+	}
+	return transposed;
+}
+
+} // namespace empire
+
+#endif // _CSR_H_
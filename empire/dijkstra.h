@@ -0,0 +1,89 @@
+﻿#ifndef _DIJKSTRA_H_
+#define _DIJKSTRA_H_
+
+#include "csr.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace empire
+{
+
+template<typename C>
+constexpr C unreachable() { return std::numeric_limits<C>::max(); }
+
+// Distances from the source and the link index leading to every node
+template<typename C>
+struct ShortestPathTree
+{
+	size_t source{0};
+	std::vector<C> distances;
+	std::vector<size_t> parents;
+
+	bool reaches(size_t v) const { return distances[v] != unreachable<C>(); }
+};
+
+// Binary heap Dijkstra over rows of links, for_each_link(v, func) calls
+// func(link, u, cost) for every link leaving v
+template<typename C, typename F>
+ShortestPathTree<C> dijkstra(size_t n, size_t source, F&& for_each_link)
+{
+	ShortestPathTree<C> tree;
+	tree.source = source;
+	tree.distances.assign(n, unreachable<C>());
+	tree.parents.assign(n, NoLink);
+
+	using Item = std::pair<C, size_t>;
+	std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+	tree.distances[source] = C{};
+	heap.push({C{}, source});
+	while (!heap.empty())
+	{
+		auto const [distance, v] = heap.top();
+		heap.pop();
+		if (distance != tree.distances[v]) continue;
+		for_each_link(v, [&](size_t link, size_t u, C cost)
+		{
+			auto const candidate = distance + cost;
+			if (candidate < tree.distances[u])
+			{
+				tree.distances[u] = candidate;
+				tree.parents[u] = link;
+				heap.push({candidate, u});
+			}
+		});
+	}
+	return tree;
+}
+
+template<typename T>
+ShortestPathTree<typename Csr<T>::cost_type> shortest_path_tree(Csr<T> const& csr, size_t source)
+{
+	return dijkstra<typename Csr<T>::cost_type>(csr.size(), source,
+		[&csr](size_t v, auto&& func)
+		{
+			for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e) func(e, csr.targets[e], csr.links[e]->cost);
+		});
+}
+
+// Links from the source of the tree to the target, empty when the target
+// is the source or is not reachable like Graph::find_path
+template<typename T>
+std::vector<typename Csr<T>::link_type*> tree_path(Csr<T> const& csr,
+	ShortestPathTree<typename Csr<T>::cost_type> const& tree, size_t target)
+{
+	std::vector<typename Csr<T>::link_type*> path;
+	if (!tree.reaches(target)) return path;
+	for (auto v = target; v != tree.source; v = csr.id(path.back()->from))
+		path.push_back(csr.links[tree.parents[v]]);
+	std::reverse(std::begin(path), std::end(path));
+	return path;
+}
+
+} // namespace empire
+
+#endif // _DIJKSTRA_H_
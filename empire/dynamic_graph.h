@@ -0,0 +1,322 @@
+﻿#ifndef _DYNAMIC_GRAPH_H_
+#define _DYNAMIC_GRAPH_H_
+
+#include "graph.h"
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace empire
+{
+
+using NodeId = size_t;
+
+// Stable link handle, the generation tells a recycled slot from the old link
+struct LinkId
+{
+	uint32_t index;
+	uint32_t generation;
+};
+
+inline bool operator==(LinkId lhs, LinkId rhs)
+{ return lhs.index == rhs.index && lhs.generation == rhs.generation; }
+
+inline bool operator!=(LinkId lhs, LinkId rhs) { return !(lhs == rhs); }
+
+template<typename U = int>
+struct DynamicLink
+{
+	NodeId from;
+	NodeId to;
+	U cost;
+};
+
+// Graph open to insertion and deletion of nodes and links. Links live in
+// one slab and form doubly linked out and in lists of their nodes, so
+// handles are indexes and survive reallocations. A removed link is unlinked
+// at once but its slot is a tombstone until compaction recycles it: an
+// iterator standing on it still finds the next live link. Compaction runs
+// after a batch when tombstones outnumber half of the live links and only
+// invalidates iterators standing on tombstones
+template<typename T, typename U = int>
+class DynamicGraph
+{
+	static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+	struct Slot
+	{
+		DynamicLink<U> link;
+		uint32_t next_out{none};
+		uint32_t prev_out{none};
+		uint32_t next_in{none};
+		uint32_t prev_in{none};
+		uint32_t generation{0};
+		bool alive{false};
+	};
+
+	struct NodeSlot
+	{
+		T value;
+		uint32_t first_out{none};
+		uint32_t last_out{none};
+		uint32_t first_in{none};
+		uint32_t last_in{none};
+		size_t out_degree{0};
+		size_t in_degree{0};
+		bool alive{true};
+	};
+
+public:
+	using value_type = T;
+	using cost_type = U;
+	using link_type = DynamicLink<U>;
+
+	template<bool Out>
+	class LinkIterator
+	{
+	public:
+		LinkIterator(DynamicGraph const* graph, uint32_t slot): graph_{graph}, slot_{slot} {}
+
+		link_type const& operator*() const { return graph_->slots_[slot_].link; }
+		link_type const* operator->() const { return &graph_->slots_[slot_].link; }
+		LinkId id() const { return {slot_, graph_->slots_[slot_].generation}; }
+
+		LinkIterator& operator++()
+		{
+			do slot_ = Out ? graph_->slots_[slot_].next_out : graph_->slots_[slot_].next_in;
+			while (slot_ != none && !graph_->slots_[slot_].alive);
+			return *this;
+		}
+
+		bool operator==(LinkIterator const& other) const { return slot_ == other.slot_; }
+		bool operator!=(LinkIterator const& other) const { return slot_ != other.slot_; }
+
+	private:
+		DynamicGraph const* graph_;
+		uint32_t slot_;
+	};
+
+	template<bool Out>
+	struct LinkRange
+	{
+		LinkIterator<Out> first;
+		LinkIterator<Out> last;
+
+		LinkIterator<Out> begin() const { return first; }
+		LinkIterator<Out> end() const { return last; }
+	};
+
+	DynamicGraph() = default;
+	explicit DynamicGraph(Graph<T, U> const& graph);
+
+	size_t size() const { return nodes_.size(); }
+	size_t nodes() const { return live_nodes_; }
+	size_t links() const { return live_links_; }
+	size_t tombstones() const { return tombstones_; }
+
+	bool contains(NodeId node) const { return node < nodes_.size() && nodes_[node].alive; }
+	bool contains(LinkId id) const
+	{
+		return id.index < slots_.size() && slots_[id.index].alive &&
+			slots_[id.index].generation == id.generation;
+	}
+
+	T& value(NodeId node) { return nodes_[node].value; }
+	T const& value(NodeId node) const { return nodes_[node].value; }
+	link_type& link(LinkId id) { return slots_[id.index].link; }
+	link_type const& link(LinkId id) const { return slots_[id.index].link; }
+
+	size_t out_degree(NodeId node) const { return nodes_[node].out_degree; }
+	size_t in_degree(NodeId node) const { return nodes_[node].in_degree; }
+	LinkRange<true> out_links(NodeId node) const
+	{ return {{this, nodes_[node].first_out}, {this, none}}; }
+	LinkRange<false> in_links(NodeId node) const
+	{ return {{this, nodes_[node].first_in}, {this, none}}; }
+
+	void reserve(size_t nodes, size_t links);
+
+	NodeId add_node(T value);
+	LinkId add_link(NodeId from, NodeId to, U cost);
+	bool remove_link(LinkId id);
+	void remove_node(NodeId node);
+
+	// Batches reserve once and compact at most once
+	template<typename It>
+	std::vector<LinkId> add_links(It first, It last);
+	template<typename It>
+	void remove_links(It first, It last);
+
+	void compact();
+
+private:
+	uint32_t allocate();
+	void unlink(uint32_t slot);
+	void maybe_compact() { if (tombstones_ > 16 && 2 * tombstones_ > live_links_) compact(); }
+
+	std::vector<NodeSlot> nodes_;
+	std::vector<Slot> slots_;
+	std::vector<uint32_t> free_;
+	std::vector<uint32_t> dead_;
+	size_t live_nodes_{0};
+	size_t live_links_{0};
+	size_t tombstones_{0};
+};
+
+template<typename T, typename U>
+DynamicGraph<T, U>::DynamicGraph(Graph<T, U> const& graph)
+{
+	std::unordered_map<typename Graph<T, U>::node_type const*, NodeId> ids;
+	ids.reserve(graph.size());
+	size_t m = 0;
+	for (auto const& node: graph)
+	{
+		ids.emplace(node.get(), ids.size());
+		m += node->links.size();
+	}
+	reserve(graph.size(), m);
+	for (auto const& node: graph) add_node(node->value);
+	for (auto const& node: graph)
+	{
+		for (auto const& l: node->links) add_link(ids[l.from], ids[l.to], l.cost);
+	}
+}
+
+template<typename T, typename U>
+void DynamicGraph<T, U>::reserve(size_t nodes, size_t links)
+{
+	nodes_.reserve(nodes);
+	slots_.reserve(links);
+}
+
+template<typename T, typename U>
+NodeId DynamicGraph<T, U>::add_node(T value)
+{
+	nodes_.push_back({std::move(value)});
+	++live_nodes_;
+	return nodes_.size() - 1;
+}
+
+template<typename T, typename U>
+uint32_t DynamicGraph<T, U>::allocate()
+{
+	if (!free_.empty())
+	{
+		auto const slot = free_.back();
+		free_.pop_back();
+		return slot;
+	}
+	slots_.emplace_back();
+	return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+template<typename T, typename U>
+LinkId DynamicGraph<T, U>::add_link(NodeId from, NodeId to, U cost)
+{
+	auto const slot = allocate();
+	auto& s = slots_[slot];
+	s.link = {from, to, std::move(cost)};
+	s.alive = true;
+	s.next_out = s.next_in = none;
+
+	auto& source = nodes_[from];
+	s.prev_out = source.last_out;
+	if (source.last_out != none) slots_[source.last_out].next_out = slot;
+	else source.first_out = slot;
+	source.last_out = slot;
+	++source.out_degree;
+
+	auto& target = nodes_[to];
+	s.prev_in = target.last_in;
+	if (target.last_in != none) slots_[target.last_in].next_in = slot;
+	else target.first_in = slot;
+	target.last_in = slot;
+	++target.in_degree;
+
+	++live_links_;
+	return {slot, s.generation};
+}
+
+template<typename T, typename U>
+void DynamicGraph<T, U>::unlink(uint32_t slot)
+{
+	auto& s = slots_[slot];
+	auto& source = nodes_[s.link.from];
+	if (s.prev_out != none) slots_[s.prev_out].next_out = s.next_out;
+	else source.first_out = s.next_out;
+	if (s.next_out != none) slots_[s.next_out].prev_out = s.prev_out;
+	else source.last_out = s.prev_out;
+	--source.out_degree;
+
+	auto& target = nodes_[s.link.to];
+	if (s.prev_in != none) slots_[s.prev_in].next_in = s.next_in;
+	else target.first_in = s.next_in;
+	if (s.next_in != none) slots_[s.next_in].prev_in = s.prev_in;
+	else target.last_in = s.prev_in;
+	--target.in_degree;
+
+	s.alive = false;
+	dead_.push_back(slot);
+	--live_links_;
+	++tombstones_;
+}
+
+template<typename T, typename U>
+bool DynamicGraph<T, U>::remove_link(LinkId id)
+{
+	if (!contains(id)) return false;
+	unlink(id.index);
+	maybe_compact();
+	return true;
+}
+
+template<typename T, typename U>
+void DynamicGraph<T, U>::remove_node(NodeId node)
+{
+	if (!contains(node)) return;
+	while (nodes_[node].first_out != none) unlink(nodes_[node].first_out);
+	while (nodes_[node].first_in != none) unlink(nodes_[node].first_in);
+	nodes_[node].alive = false;
+	--live_nodes_;
+	maybe_compact();
+}
+
+template<typename T, typename U>
+template<typename It>
+std::vector<LinkId> DynamicGraph<T, U>::add_links(It first, It last)
+{
+	std::vector<LinkId> ids;
+	auto const count = static_cast<size_t>(std::distance(first, last));
+	ids.reserve(count);
+	if (count > free_.size()) slots_.reserve(slots_.size() + count - free_.size());
+	for (auto it = first; it != last; ++it) ids.push_back(add_link(it->from, it->to, it->cost));
+	return ids;
+}
+
+template<typename T, typename U>
+template<typename It>
+void DynamicGraph<T, U>::remove_links(It first, It last)
+{
+	for (auto it = first; it != last; ++it)
+	{
+		if (contains(*it)) unlink(it->index);
+	}
+	maybe_compact();
+}
+
+template<typename T, typename U>
+void DynamicGraph<T, U>::compact()
+{
+	for (auto slot: dead_)
+	{
+		++slots_[slot].generation;
+		free_.push_back(slot);
+	}
+	dead_.clear();
+	tombstones_ = 0;
+}
+
+} // namespace empire
+
+#endif // _DYNAMIC_GRAPH_H_
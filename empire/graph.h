@@ -4,8 +4,11 @@
 #include "traverse.h"
 
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
 #include <unordered_map>
 #include <iostream>
 #include <vector>
@@ -36,14 +39,34 @@ struct Node
 	using node_type = Node<T, U>;
 	using link_type = Link<node_type, cost_type>;
 
-	explicit Node(value_type&& v) : value{std::forward<value_type>(v)} {}
+	explicit Node(value_type&& v, std::pmr::memory_resource* resource = std::pmr::new_delete_resource())
+		: value{std::forward<value_type>(v)}, links{resource} {}
 
 	value_type value;
-	std::vector<link_type> links;
+	std::pmr::vector<link_type> links;
+};
+
+// Nodes placed in an arena are only destroyed, the memory is released
+// with the arena and trivial nodes are not even visited
+template<typename T>
+struct NodeDeleter
+{
+	bool owned{true};
+
+	void operator()(T* node) const
+	{
+		using value_type = typename T::value_type;
+		using cost_type = typename T::cost_type;
+		if (owned) delete node;
+		else if constexpr (!std::is_trivially_destructible_v<value_type> ||
+			!std::is_trivially_destructible_v<cost_type>) node->~T();
+	}
 };
 
 template<typename T, typename U = int>
-using NodePtr = std::unique_ptr<Node<T, U>>;
+using NodePtr = std::unique_ptr<Node<T, U>, NodeDeleter<Node<T, U>>>;
+
+using Arena = std::pmr::monotonic_buffer_resource;
 
 enum class Traverse { Width, Depth, Mark, Remark };
 
@@ -53,7 +76,7 @@ namespace
 template<typename T, typename U = int>
 NodePtr<T, U> make_node(T&& value)
 {
-	return std::make_unique<Node<T, U>>(std::forward<T>(value));
+	return NodePtr<T, U>{new Node<T, U>(std::forward<T>(value))};
 }
 
 template<typename T, typename F>
@@ -108,7 +131,8 @@ struct Graph
 	using node_iterator = typename std::vector<NodePtr<T, U>>::const_iterator;
 	using reverse_node_iterator = typename std::vector<NodePtr<T, U>>::const_reverse_iterator;
 	
-	Graph(std::vector<NodePtr<T, U>> nodes): nodes_{std::move(nodes)} {}
+	Graph(std::vector<NodePtr<T, U>> nodes, std::shared_ptr<Arena> arena = nullptr):
+		arena_{std::move(arena)}, nodes_{std::move(nodes)} {}
 
 	size_t size() const { return nodes_.size(); }
 	node_type* operator[](int i) const { return nodes_[i].get(); }
@@ -135,6 +159,45 @@ struct Graph
 	}
 
 private:
+	std::shared_ptr<Arena> arena_;
+	std::vector<NodePtr<T, U>> nodes_;
+};
+
+// Places the nodes and their exactly sized link vectors in one arena
+// owned by the graph, the degrees have to be known before the nodes
+template<typename T, typename U = int>
+class GraphBuilder
+{
+public:
+	using node_type = Node<T, U>;
+	using link_type = Link<node_type, U>;
+
+	GraphBuilder(size_t nodes, size_t links):
+		arena_{std::make_shared<Arena>(nodes * sizeof(node_type) + links * sizeof(link_type) + 64)}
+	{
+		nodes_.reserve(nodes);
+	}
+
+	node_type* add_node(T&& value, size_t degree)
+	{
+		auto place = arena_->allocate(sizeof(node_type), alignof(node_type));
+		nodes_.emplace_back(new (place) node_type(std::forward<T>(value), arena_.get()),
+			NodeDeleter<node_type>{false});
+		nodes_.back()->links.reserve(degree);
+		return nodes_.back().get();
+	}
+
+	node_type* operator[](size_t i) const { return nodes_[i].get(); }
+
+	void add_link(size_t from, size_t to, U cost)
+	{
+		nodes_[from]->links.emplace_back(nodes_[from].get(), nodes_[to].get(), std::move(cost));
+	}
+
+	Graph<T, U> build() { return {std::move(nodes_), std::move(arena_)}; }
+
+private:
+	std::shared_ptr<Arena> arena_;
 	std::vector<NodePtr<T, U>> nodes_;
 };
 
@@ -146,19 +209,14 @@ Graph<T, U> make_graph(
 	std::vector<T> values,
 	std::vector<MetaLink<U>> links)
 {
-	std::vector<NodePtr<T, U>> nodes;
-	nodes.reserve(values.size());
-	std::transform(std::begin(values), std::end(values), std::back_inserter(nodes),
-		[](auto& v) { return make_node<T, U>(std::move(v)); });
+	std::vector<size_t> degrees(values.size(), 0);
+	for (auto const& l : links) ++degrees[l.from];
 
-	for (auto& l : links)
-	{
-		nodes[l.from]->links.push_back({nodes[l.from].get(),
-										nodes[l.to].get(),
-										std::move(l.cost)});
-	}
+	GraphBuilder<T, U> builder{values.size(), links.size()};
+	for (size_t i = 0; i < values.size(); ++i) builder.add_node(std::move(values[i]), degrees[i]);
+	for (auto& l : links) builder.add_link(l.from, l.to, std::move(l.cost));
 
-	return {std::move(nodes)};
+	return builder.build();
 }
 
 } // namespace empire
@@ -0,0 +1,245 @@
+﻿#ifndef _GRAPH_FILE_H_
+#define _GRAPH_FILE_H_
+
+#include "csr.h"
+#include "graph.h"
+
+#include "../core/mapped_file.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace empire
+{
+
+// Binary graph in native byte order: the header is followed by node values,
+// CSR offsets and targets as 64 bit ids and link costs, every section
+// starts at a multiple of 8 bytes
+struct GraphFileHeader
+{
+	char magic[4]{'E', 'M', 'P', 'G'};
+	uint32_t version{1};
+	uint32_t value_size{0};
+	uint32_t cost_size{0};
+	uint64_t nodes{0};
+	uint64_t edges{0};
+};
+
+constexpr uint32_t GraphFileVersion = 1;
+
+namespace
+{
+
+constexpr size_t align8(size_t size) { return (size + 7) & ~size_t{7}; }
+
+template<typename T, typename U>
+struct GraphFileLayout
+{
+	size_t values;
+	size_t offsets;
+	size_t targets;
+	size_t costs;
+	size_t size;
+
+	GraphFileLayout(uint64_t nodes, uint64_t edges)
+	{
+		values = align8(sizeof(GraphFileHeader));
+		offsets = align8(values + nodes * sizeof(T));
+		targets = offsets + (nodes + 1) * sizeof(uint64_t);
+		costs = align8(targets + edges * sizeof(uint64_t));
+		size = costs + edges * sizeof(U);
+	}
+};
+
+void write_padding(std::ostream& out, size_t& written, size_t position)
+{
+	static char const zeros[8]{};
+	out.write(zeros, position - written);
+	written = position;
+}
+
+template<typename T>
+void write_raw(std::ostream& out, size_t& written, T const* data, size_t count)
+{
+	out.write(reinterpret_cast<char const*>(data), count * sizeof(T));
+	written += count * sizeof(T);
+}
+
+template<typename T>
+void read_raw(std::istream& in, T* data, size_t count)
+{
+	in.read(reinterpret_cast<char*>(data), count * sizeof(T));
+	if (!in) throw std::runtime_error{"truncated graph file"};
+}
+
+template<typename T, typename U>
+void check_header(GraphFileHeader const& header)
+{
+	if (std::memcmp(header.magic, GraphFileHeader{}.magic, sizeof(header.magic)) != 0)
+		throw std::runtime_error{"not a graph file"};
+	if (header.version != GraphFileVersion) throw std::runtime_error{"unsupported graph file version"};
+	if (header.value_size != sizeof(T) || header.cost_size != sizeof(U))
+		throw std::runtime_error{"graph file types mismatch"};
+
+	// Counts that keep every section of the layout, and their sum, far
+	// from overflowing size_t
+	constexpr auto limit = std::numeric_limits<size_t>::max() / 4;
+	if (header.nodes >= limit / (sizeof(T) + sizeof(uint64_t))
+		|| header.edges >= limit / (sizeof(U) + sizeof(uint64_t)))
+		throw std::runtime_error{"graph file too large"};
+}
+
+// Offsets start at 0, never decrease and end at the edge count, targets
+// are node ids
+void check_arrays(size_t nodes, size_t edges, uint64_t const* offsets, uint64_t const* targets)
+{
+	if (offsets[0] != 0 || offsets[nodes] != edges) throw std::runtime_error{"corrupt graph file offsets"};
+	for (size_t v = 0; v < nodes; ++v)
+		if (offsets[v + 1] < offsets[v]) throw std::runtime_error{"corrupt graph file offsets"};
+	for (size_t e = 0; e < edges; ++e)
+		if (targets[e] >= nodes) throw std::runtime_error{"corrupt graph file targets"};
+}
+
+} // namespace
+
+template<typename T, typename U>
+void write_graph(std::ostream& out, Graph<T, U> const& graph)
+{
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<U>,
+		"only trivially copyable values and costs can be stored");
+
+	auto const csr = make_csr(graph);
+	GraphFileHeader header;
+	header.value_size = sizeof(T);
+	header.cost_size = sizeof(U);
+	header.nodes = csr.size();
+	header.edges = csr.edges();
+	GraphFileLayout<T, U> const layout{header.nodes, header.edges};
+
+	size_t written = 0;
+	write_raw(out, written, &header, 1);
+	write_padding(out, written, layout.values);
+	for (auto node: csr.nodes) write_raw(out, written, &node->value, 1);
+	write_padding(out, written, layout.offsets);
+
+	std::vector<uint64_t> ids(std::begin(csr.offsets), std::end(csr.offsets));
+	write_raw(out, written, ids.data(), ids.size());
+	ids.assign(std::begin(csr.targets), std::end(csr.targets));
+	write_raw(out, written, ids.data(), ids.size());
+	write_padding(out, written, layout.costs);
+	for (auto link: csr.links) write_raw(out, written, &link->cost, 1);
+}
+
+template<typename T, typename U>
+void save_graph(std::string const& path, Graph<T, U> const& graph)
+{
+	std::ofstream out{path, std::ios::binary};
+	if (!out) throw std::runtime_error{"cannot create " + path};
+	write_graph(out, graph);
+	if (!out) throw std::runtime_error{"cannot write " + path};
+}
+
+// Mapped graph file, values, edges and costs are read in place
+template<typename T, typename U = int>
+class GraphFile
+{
+public:
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<U>,
+		"only trivially copyable values and costs can be stored");
+
+	explicit GraphFile(std::string const& path);
+
+	size_t size() const { return header_.nodes; }
+	size_t edges() const { return header_.edges; }
+	size_t degree(size_t v) const { return offsets_[v + 1] - offsets_[v]; }
+
+	T const& value(size_t v) const { return values_[v]; }
+	uint64_t const* offsets() const { return offsets_; }
+	uint64_t const* targets() const { return targets_; }
+	U const& cost(size_t e) const { return costs_[e]; }
+
+	Graph<T, U> to_graph() const;
+
+private:
+	core::MappedFile file_;
+	GraphFileHeader header_;
+	T const* values_{nullptr};
+	uint64_t const* offsets_{nullptr};
+	uint64_t const* targets_{nullptr};
+	U const* costs_{nullptr};
+};
+
+template<typename T, typename U>
+GraphFile<T, U>::GraphFile(std::string const& path): file_{path}
+{
+	if (file_.size() < sizeof(GraphFileHeader)) throw std::runtime_error{"truncated graph file"};
+	std::memcpy(&header_, file_.data(), sizeof(header_));
+	check_header<T, U>(header_);
+
+	GraphFileLayout<T, U> const layout{header_.nodes, header_.edges};
+	if (file_.size() < layout.size) throw std::runtime_error{"truncated graph file"};
+	values_ = reinterpret_cast<T const*>(file_.data() + layout.values);
+	offsets_ = reinterpret_cast<uint64_t const*>(file_.data() + layout.offsets);
+	targets_ = reinterpret_cast<uint64_t const*>(file_.data() + layout.targets);
+	costs_ = reinterpret_cast<U const*>(file_.data() + layout.costs);
+	check_arrays(header_.nodes, header_.edges, offsets_, targets_);
+}
+
+namespace
+{
+
+template<typename T, typename U>
+Graph<T, U> graph_from_arrays(size_t n, T const* values, uint64_t const* offsets,
+	uint64_t const* targets, U const* costs)
+{
+	GraphBuilder<T, U> builder{n, offsets[n]};
+	for (size_t v = 0; v < n; ++v) builder.add_node(T{values[v]}, offsets[v + 1] - offsets[v]);
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (auto e = offsets[v]; e < offsets[v + 1]; ++e) builder.add_link(v, targets[e], costs[e]);
+	}
+	return builder.build();
+}
+
+} // namespace
+
+template<typename T, typename U>
+Graph<T, U> GraphFile<T, U>::to_graph() const
+{
+	return graph_from_arrays(size(), values_, offsets_, targets_, costs_);
+}
+
+template<typename T, typename U = int>
+Graph<T, U> read_graph(std::istream& in)
+{
+	GraphFileHeader header;
+	read_raw(in, &header, 1);
+	check_header<T, U>(header);
+	GraphFileLayout<T, U> const layout{header.nodes, header.edges};
+
+	std::vector<T> values(header.nodes);
+	std::vector<uint64_t> offsets(header.nodes + 1);
+	std::vector<uint64_t> targets(header.edges);
+	std::vector<U> costs(header.edges);
+	in.ignore(layout.values - sizeof(header));
+	read_raw(in, values.data(), values.size());
+	in.ignore(layout.offsets - layout.values - values.size() * sizeof(T));
+	read_raw(in, offsets.data(), offsets.size());
+	read_raw(in, targets.data(), targets.size());
+	in.ignore(layout.costs - layout.targets - targets.size() * sizeof(uint64_t));
+	read_raw(in, costs.data(), costs.size());
+	check_arrays(header.nodes, header.edges, offsets.data(), targets.data());
+	return graph_from_arrays(header.nodes, values.data(), offsets.data(), targets.data(), costs.data());
+}
+
+} // namespace empire
+
+#endif // _GRAPH_FILE_H_
@@ -0,0 +1,194 @@
+﻿#ifndef _GRAPH_IMPORT_H_
+#define _GRAPH_IMPORT_H_
+
+#include "graph.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace empire
+{
+
+// Splits a stream into lines reading it by chunks,
+// a line is valid until the next call
+class LineReader
+{
+public:
+	explicit LineReader(std::istream& in, size_t chunk = 1 << 20): in_{in}, buffer_(chunk) {}
+
+	bool next(std::string_view& line)
+	{
+		while (true)
+		{
+			auto const begin = buffer_.data() + first_;
+			auto const end = buffer_.data() + last_;
+			if (auto const eol = static_cast<char const*>(std::memchr(begin, '\n', end - begin)))
+			{
+				line = {begin, static_cast<size_t>(eol - begin)};
+				first_ += line.size() + 1;
+				++number_;
+				return true;
+			}
+			if (!fill())
+			{
+				if (first_ == last_) return false;
+				line = {begin, last_ - first_};
+				first_ = last_;
+				++number_;
+				return true;
+			}
+		}
+	}
+
+	size_t number() const { return number_; }
+
+private:
+	bool fill()
+	{
+		if (!in_) return false;
+		std::copy(buffer_.data() + first_, buffer_.data() + last_, buffer_.data());
+		last_ -= first_;
+		first_ = 0;
+		if (last_ == buffer_.size()) buffer_.resize(2 * buffer_.size());
+		in_.read(buffer_.data() + last_, buffer_.size() - last_);
+		last_ += in_.gcount();
+		return in_.gcount() > 0;
+	}
+
+	std::istream& in_;
+	std::vector<char> buffer_;
+	size_t first_{0};
+	size_t last_{0};
+	size_t number_{0};
+};
+
+namespace
+{
+
+class Fields
+{
+public:
+	Fields(std::string_view line, size_t number): line_{line}, number_{number} {}
+
+	bool empty()
+	{
+		skip();
+		return line_.empty();
+	}
+
+	// First character of the next field, the line must not be empty
+	char peek()
+	{
+		skip();
+		return line_.front();
+	}
+
+	std::string_view word()
+	{
+		skip();
+		auto const size = std::min(line_.find_first_of(" \t\r"), line_.size());
+		auto const word = line_.substr(0, size);
+		line_.remove_prefix(size);
+		return word;
+	}
+
+	template<typename T>
+	T number()
+	{
+		auto const w = word();
+		T value{};
+		auto const [end, error] = std::from_chars(w.data(), w.data() + w.size(), value);
+		if (w.empty() || error != std::errc{} || end != w.data() + w.size())
+			throw std::runtime_error{"bad number at line " + std::to_string(number_)};
+		return value;
+	}
+
+private:
+	void skip()
+	{
+		while (!line_.empty() && (line_.front() == ' ' || line_.front() == '\t' || line_.front() == '\r'))
+			line_.remove_prefix(1);
+	}
+
+	std::string_view line_;
+	size_t number_;
+};
+
+template<typename U>
+Graph<size_t, U> make_id_graph(size_t n, std::vector<MetaLink<U>>& links)
+{
+	std::vector<size_t> degrees(n, 0);
+	for (auto const& l: links) ++degrees[l.from];
+
+	GraphBuilder<size_t, U> builder{n, links.size()};
+	for (size_t v = 0; v < n; ++v) builder.add_node(size_t{v}, degrees[v]);
+	for (auto& l: links) builder.add_link(l.from, l.to, std::move(l.cost));
+	return builder.build();
+}
+
+} // namespace
+
+// Lines "from to [cost]" with zero based ids, lines whose first field
+// starts with '#' or '%' are comments, node values are the ids
+template<typename U = int>
+Graph<size_t, U> read_edge_list(std::istream& in)
+{
+	LineReader reader{in};
+	std::vector<MetaLink<U>> links;
+	size_t n = 0;
+	std::string_view line;
+	while (reader.next(line))
+	{
+		Fields fields{line, reader.number()};
+		if (fields.empty() || fields.peek() == '#' || fields.peek() == '%') continue;
+		MetaLink<U> link{fields.template number<size_t>(), fields.template number<size_t>(), U{}};
+		if (!fields.empty()) link.cost = fields.template number<U>();
+		n = std::max(n, std::max(link.from, link.to) + 1);
+		links.push_back(std::move(link));
+	}
+	return make_id_graph(n, links);
+}
+
+// DIMACS shortest path ("p sp n m", "a u v w") and coloring
+// ("p edge n m", "e u v") formats, one based ids become zero based
+template<typename U = int>
+Graph<size_t, U> read_dimacs(std::istream& in)
+{
+	LineReader reader{in};
+	std::vector<MetaLink<U>> links;
+	size_t n = 0;
+	std::string_view line;
+	while (reader.next(line))
+	{
+		Fields fields{line, reader.number()};
+		if (fields.empty()) continue;
+		auto const kind = fields.word();
+		if (kind == "c") continue;
+		if (kind == "p")
+		{
+			fields.word();
+			n = fields.template number<size_t>();
+			links.reserve(fields.template number<size_t>());
+			continue;
+		}
+		if (kind != "a" && kind != "e")
+			throw std::runtime_error{"unknown line at " + std::to_string(reader.number())};
+
+		auto const from = fields.template number<size_t>();
+		auto const to = fields.template number<size_t>();
+		if (from == 0 || to == 0 || from > n || to > n)
+			throw std::runtime_error{"bad node id at line " + std::to_string(reader.number())};
+		links.push_back({from - 1, to - 1, kind == "a" ? fields.template number<U>() : U{}});
+	}
+	return make_id_graph(n, links);
+}
+
+} // namespace empire
+
+#endif // _GRAPH_IMPORT_H_
@@ -0,0 +1,169 @@
+﻿#ifndef _LANDMARKS_H_
+#define _LANDMARKS_H_
+
+#include "csr.h"
+#include "dijkstra.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace empire
+{
+
+// ALT: A* whose lower bound comes from distances to and from a few
+// landmarks through the triangle inequality. Landmarks are picked one
+// by one as the node farthest from the ones already picked
+template<typename T>
+class Landmarks
+{
+public:
+	using node_type = typename T::node_type;
+	using link_type = typename T::link_type;
+	using cost_type = typename link_type::cost_type;
+
+	explicit Landmarks(T const& graph, size_t count = 8);
+
+	std::vector<link_type*> find_path(node_type const* from, node_type const* to);
+
+	std::vector<node_type*> landmarks() const;
+	size_t settled() const { return settled_; }
+
+private:
+	cost_type lower_bound(size_t v, size_t t) const;
+
+	Csr<T> csr_;
+	size_t count_{0};
+	std::vector<size_t> landmarks_;
+	std::vector<cost_type> from_landmark_;
+	std::vector<cost_type> to_landmark_;
+
+	std::vector<cost_type> distances_;
+	std::vector<size_t> parents_;
+	std::vector<bool> closed_;
+	std::vector<size_t> touched_;
+	size_t settled_{0};
+};
+
+template<typename T>
+Landmarks<T>::Landmarks(T const& graph, size_t count): csr_{make_csr(graph)}
+{
+	auto const n = csr_.size();
+	count_ = std::min(count, n);
+	from_landmark_.assign(n * count_, unreachable<cost_type>());
+	to_landmark_.assign(n * count_, unreachable<cost_type>());
+
+	auto const transposed = make_transposed(csr_);
+	std::vector<cost_type> nearest(n, unreachable<cost_type>());
+	size_t next = 0;
+	for (size_t i = 0; i < count_; ++i)
+	{
+		landmarks_.push_back(next);
+		auto const forward = shortest_path_tree(csr_, next);
+		auto const backward = dijkstra<cost_type>(n, next,
+			[this, &transposed](size_t v, auto&& func)
+			{
+				for (auto j = transposed.offsets[v]; j < transposed.offsets[v + 1]; ++j)
+					func(transposed.links[j], transposed.sources[j], csr_.links[transposed.links[j]]->cost);
+			});
+		for (size_t v = 0; v < n; ++v)
+		{
+			from_landmark_[v * count_ + i] = forward.distances[v];
+			to_landmark_[v * count_ + i] = backward.distances[v];
+			if (forward.reaches(v)) nearest[v] = std::min(nearest[v], forward.distances[v]);
+		}
+
+		// The farthest reached node, an unreached one opens another component
+		auto farthest = std::max_element(std::begin(nearest), std::end(nearest),
+			[](cost_type a, cost_type b)
+			{
+				if (a == unreachable<cost_type>() || b == unreachable<cost_type>()) return b == unreachable<cost_type>() && a != b;
+				return a < b;
+			});
+		next = farthest - std::begin(nearest);
+	}
+
+	distances_.assign(n, unreachable<cost_type>());
+	parents_.assign(n, NoLink);
+	closed_.assign(n, false);
+}
+
+template<typename T>
+std::vector<typename Landmarks<T>::node_type*> Landmarks<T>::landmarks() const
+{
+	std::vector<node_type*> nodes;
+	for (auto l: landmarks_) nodes.push_back(csr_.nodes[l]);
+	return nodes;
+}
+
+// Only the bounds with both distances known are admissible
+template<typename T>
+typename Landmarks<T>::cost_type Landmarks<T>::lower_bound(size_t v, size_t t) const
+{
+	auto const none = unreachable<cost_type>();
+	cost_type bound{};
+	for (size_t i = 0; i < count_; ++i)
+	{
+		auto const lv = from_landmark_[v * count_ + i];
+		auto const lt = from_landmark_[t * count_ + i];
+		if (lv != none && lt != none && lt > lv) bound = std::max(bound, lt - lv);
+		auto const vl = to_landmark_[v * count_ + i];
+		auto const tl = to_landmark_[t * count_ + i];
+		if (vl != none && tl != none && vl > tl) bound = std::max(bound, vl - tl);
+	}
+	return bound;
+}
+
+template<typename T>
+std::vector<typename Landmarks<T>::link_type*>
+Landmarks<T>::find_path(node_type const* from, node_type const* to)
+{
+	auto const s = csr_.id(from);
+	auto const t = csr_.id(to);
+	for (auto v: touched_)
+	{
+		distances_[v] = unreachable<cost_type>();
+		parents_[v] = NoLink;
+		closed_[v] = false;
+	}
+	touched_.clear();
+	settled_ = 0;
+
+	using Item = std::pair<cost_type, size_t>;
+	std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+	distances_[s] = cost_type{};
+	touched_.push_back(s);
+	heap.push({lower_bound(s, t), s});
+	while (!heap.empty())
+	{
+		auto const v = heap.top().second;
+		heap.pop();
+		if (closed_[v]) continue;
+		closed_[v] = true;
+		++settled_;
+		if (v == t) break;
+
+		for (auto e = csr_.offsets[v]; e < csr_.offsets[v + 1]; ++e)
+		{
+			auto const u = csr_.targets[e];
+			auto const candidate = distances_[v] + csr_.links[e]->cost;
+			if (closed_[u] || !(candidate < distances_[u])) continue;
+			if (distances_[u] == unreachable<cost_type>()) touched_.push_back(u);
+			distances_[u] = candidate;
+			parents_[u] = e;
+			heap.push({candidate + lower_bound(u, t), u});
+		}
+	}
+
+	std::vector<link_type*> path;
+	if (s == t || parents_[t] == NoLink) return path;
+	for (auto v = t; v != s; v = csr_.id(path.back()->from)) path.push_back(csr_.links[parents_[v]]);
+	std::reverse(std::begin(path), std::end(path));
+	return path;
+}
+
+} // namespace empire
+
+#endif // _LANDMARKS_H_
@@ -0,0 +1,72 @@
+﻿#ifndef _LEVELS_H_
+#define _LEVELS_H_
+
+#include "csr.h"
+
+#include "../core/parallel.h"
+
+#include <atomic>
+#include <vector>
+
+namespace empire
+{
+
+constexpr size_t LevelsGrain = 256;
+
+// Level synchronous width traversal: the frontier is split in ranges
+// stolen by the workers, a node joins the next frontier of the range
+// that claims it first. Levels count links from the source, NoLink
+// marks the nodes it does not reach
+template<typename T>
+std::vector<size_t> width_levels(Csr<T> const& csr, size_t source, size_t grain = LevelsGrain)
+{
+	auto const n = csr.size();
+	std::vector<std::atomic<size_t>> claimed(n);
+	for (auto& c: claimed) c.store(NoLink, std::memory_order_relaxed);
+
+	std::vector<size_t> frontier{source};
+	claimed[source].store(0, std::memory_order_relaxed);
+	for (size_t level = 1; !frontier.empty(); ++level)
+	{
+		frontier = core::parallel_reduce(0, frontier.size(), std::vector<size_t>{},
+			[&](size_t first, size_t last)
+			{
+				std::vector<size_t> next;
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = frontier[i];
+					for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+					{
+						auto const u = csr.targets[e];
+						auto expected = NoLink;
+						if (claimed[u].load(std::memory_order_relaxed) == NoLink &&
+							claimed[u].compare_exchange_strong(expected, level, std::memory_order_relaxed))
+							next.push_back(u);
+					}
+				}
+				return next;
+			},
+			[](std::vector<size_t> lhs, std::vector<size_t> rhs)
+			{
+				lhs.insert(std::end(lhs), std::begin(rhs), std::end(rhs));
+				return lhs;
+			},
+			grain);
+	}
+
+	std::vector<size_t> levels(n);
+	for (size_t v = 0; v < n; ++v) levels[v] = claimed[v].load(std::memory_order_relaxed);
+	return levels;
+}
+
+template<typename T, typename U>
+std::vector<size_t> width_levels(Graph<T, U> const& graph, typename Graph<T, U>::node_type const* source,
+	size_t grain = LevelsGrain)
+{
+	auto const csr = make_csr(graph);
+	return width_levels(csr, csr.id(source), grain);
+}
+
+} // namespace empire
+
+#endif // _LEVELS_H_
@@ -1,8 +1,17 @@
 ﻿#ifndef _MAXIMAZER_H_
 #define _MAXIMAZER_H_
 
+#include "csr.h"
+#include "dynamic_graph.h"
 #include "graph.h"
 
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 namespace empire
 {
 
@@ -10,10 +19,8 @@ struct Pipe
 {
 	int volume;	
 	int flow{0};
-	Pipe* residual{nullptr};
- 
+
 	int residual_flow() const { return volume - flow; }
-	Pipe residual_pipe() { return {volume, residual_flow(), this}; }
 
 	operator std::string() const
 	{ return std::to_string(flow) + '/' + std::to_string(volume); }
@@ -27,137 +34,169 @@ bool operator<(Pipe const& lhs, Pipe const& rhs)
 
 namespace {
 
+struct Residual
+{
+	size_t link;
+	bool backward;
+};
+
+// Residual network kept beside the graph: a link has a forward residual
+// link while it is not full and a backward one while it carries flow,
+// residual links appear and disappear as the flow changes
 template<typename T>
-struct Network
+class ResidualNetwork
 {
+public:
 	using link_type = typename T::link_type;
 
-	T graph;
-	std::vector<link_type> filled;
+	explicit ResidualNetwork(T& graph);
+
+	bool augment(size_t source, size_t sink);
+	std::vector<bool> reachable(size_t source) const;
+	Csr<T> const& csr() const { return csr_; }
+
+private:
+	int capacity(Residual const& r) const
+	{
+		auto const& pipe = csr_.links[r.link]->cost;
+		return r.backward ? pipe.flow : pipe.residual_flow();
+	}
+
+	void update(size_t link);
+
+	Csr<T> csr_;
+	DynamicGraph<size_t, Residual> net_;
+	std::vector<std::optional<LinkId>> forward_;
+	std::vector<std::optional<LinkId>> backward_;
+	std::vector<LinkId> parents_;
 };
 
 template<typename T>
-int minimal_residual(T const& path)
+ResidualNetwork<T>::ResidualNetwork(T& graph):
+	csr_{make_csr(graph)}, forward_(csr_.edges()), backward_(csr_.edges())
 {
-	auto min = std::min_element(std::begin(path), std::end(path),
-		[](auto const& lhs, auto const& rhs)
-			{ return lhs->cost.residual_flow() < rhs->cost.residual_flow(); });
-	return min != std::end(path) ? (*min)->cost.residual_flow() : 0;
+	net_.reserve(csr_.size(), 2 * csr_.edges());
+	for (size_t v = 0; v < csr_.size(); ++v) net_.add_node(v);
+	for (size_t e = 0; e < csr_.edges(); ++e) update(e);
+	net_.compact();
 }
 
 template<typename T>
-void improve_stream(T& path, int additional_flow)
+void ResidualNetwork<T>::update(size_t link)
 {
-	for (auto& p: path)
+	auto const& l = *csr_.links[link];
+	auto const from = csr_.id(l.from);
+	auto const to = csr_.id(l.to);
+
+	auto sync = [this](std::optional<LinkId>& id, Residual residual, size_t a, size_t b)
 	{
-		if (p->cost.residual)
-		{
-			p->cost.residual->flow -= additional_flow;
-		}
-		else
+		auto const open = capacity(residual) > 0;
+		if (open && !id) id = net_.add_link(a, b, residual);
+		else if (!open && id)
 		{
-			p->cost.flow += additional_flow;
+			net_.remove_link(*id);
+			id.reset();
 		}
-	}
+	};
+	sync(forward_[link], {link, false}, from, to);
+	sync(backward_[link], {link, true}, to, from);
 }
 
+// Breadth first search of the shortest augmenting path
 template<typename T>
-Network<T> add_residual_network(T&& graph)
+bool ResidualNetwork<T>::augment(size_t source, size_t sink)
 {
-	Network<T> net{std::forward<T>(graph)};
-	for (auto const& n: net.graph)
+	parents_.assign(net_.size(), LinkId{0, 0});
+	std::vector<bool> visited(net_.size(), false);
+	std::vector<size_t> queue{source};
+	visited[source] = true;
+	for (size_t head = 0; head < queue.size() && !visited[sink]; ++head)
 	{
-		for (auto& l: n->links)
+		auto const v = queue[head];
+		auto const range = net_.out_links(v);
+		for (auto it = range.begin(); it != range.end(); ++it)
 		{
-			auto border = std::partition(std::begin(n->links), std::end(n->links),
-				[](auto const& l){ return l.cost.residual_flow() != 0; });
-			std::move(border, std::end(n->links), std::back_inserter(net.filled));
-			n->links.erase(border, std::end(n->links));
+			if (visited[it->to]) continue;
+			visited[it->to] = true;
+			parents_[it->to] = it.id();
+			queue.push_back(it->to);
 		}
 	}
-	
-	auto add_residual_pipe = [](auto& l){
-		auto pipe = l.cost.residual_pipe();
-		if (pipe.residual_flow() != 0)
-		{
-			l.to->links.emplace_back(l.to, l.from, std::move(pipe));
-		}
-	};
+	if (!visited[sink] || source == sink) return false;
 
-	for (auto const& n: net.graph)
-	{
-		for (auto& l: n->links)
-		{
-			if (!l.cost.residual)
-			{
-				add_residual_pipe(l);
-			}
-		}
-	}
-	for (auto& l: net.filled)
+	auto flow = std::numeric_limits<int>::max();
+	for (auto v = sink; v != source; v = net_.link(parents_[v]).from)
+		flow = std::min(flow, capacity(net_.link(parents_[v]).cost));
+
+	std::vector<size_t> changed;
+	for (auto v = sink; v != source; v = net_.link(parents_[v]).from)
 	{
-		add_residual_pipe(l);
+		auto const& residual = net_.link(parents_[v]).cost;
+		auto& pipe = csr_.links[residual.link]->cost;
+		pipe.flow += residual.backward ? -flow : flow;
+		changed.push_back(residual.link);
 	}
-	return net;
+	for (auto link: changed) update(link);
+	return true;
 }
 
-} // namespace
-
 template<typename T>
-T remove_residual_network(Network<T>&& net)
+std::vector<bool> ResidualNetwork<T>::reachable(size_t source) const
 {
-	for (auto const& n: net.graph)
-	{
-		n->links.erase(
-			std::remove_if(std::begin(n->links), std::end(n->links),
-				[](auto const& l){ return l.cost.residual; }),
-			std::end(n->links));
-	}
-	for (auto& l: net.filled)
+	std::vector<bool> visited(net_.size(), false);
+	std::vector<size_t> stack{source};
+	visited[source] = true;
+	while (!stack.empty())
 	{
-		l.from->links.push_back(std::move(l));
+		auto const v = stack.back();
+		stack.pop_back();
+		for (auto const& l: net_.out_links(v))
+		{
+			if (visited[l.to]) continue;
+			visited[l.to] = true;
+			stack.push_back(l.to);
+		}
 	}
-	return std::move(net.graph);
+	return visited;
 }
 
+} // namespace
+
+// Edmonds-Karp from the first node to the last one, flows are written
+// to the pipes and the links of the graph are left in place
 template<typename T>
 T maximize_stream(T&& graph)
 {
-	auto net = add_residual_network(std::forward<T>(graph));
-	auto path = net.graph.find_path(std::begin(net.graph)->get(),
-									std::rbegin(net.graph)->get());
-
-	while (!path.empty())
+	if (graph.size() > 1)
 	{
-		auto min = minimal_residual(path);
-		improve_stream(path, min);
-		net = add_residual_network(remove_residual_network(std::move(net)));
-	
-		path = net.graph.find_path(std::begin(net.graph)->get(),
-								   std::rbegin(net.graph)->get());
+		ResidualNetwork<std::decay_t<T>> net{graph};
+		while (net.augment(0, graph.size() - 1)) {}
 	}
-	return remove_residual_network(std::move(net));
+	return std::move(graph);
 }
 
+// Keeps the source side of a minimal cut without the links leaving it
 template<typename T>
 T cut_maximized_stream(T&& stream)
 {
-	auto net = add_residual_network(std::move(stream));
-	std::unordered_set<typename T::node_type*> a;
-	net.graph.traverse(net.graph.begin()->get(),
-		[&a](auto l) {
-			a.insert(l->from);
-			a.insert(l->to);
-		});
-	auto graph = remove_residual_network(std::move(net));
-	for (auto n: a)
+	if (stream.size() == 0) return std::move(stream);
+
+	ResidualNetwork<std::decay_t<T>> net{stream};
+	auto const a = net.reachable(0);
+	auto const& csr = net.csr();
+	// The stream is a plain graph, so its links are erased in place. That
+	// leaves the link pointers of the network dangling, which is safe as
+	// only its node ids are looked up from here on
+	for (size_t v = 0; v < csr.size(); ++v)
 	{
-		n->links.erase(
-			std::remove_if(std::begin(n->links), std::end(n->links),
-				[&a](auto const& l){ return a.count(l.to) == 0; }),
-			std::end(n->links));
+		if (!a[v]) continue;
+		auto& links = csr.nodes[v]->links;
+		links.erase(
+			std::remove_if(std::begin(links), std::end(links),
+				[&a, &csr](auto const& l){ return !a[csr.id(l.to)]; }),
+			std::end(links));
 	}
-	return graph;
+	return std::move(stream);
 }
 
 } // namespace empire
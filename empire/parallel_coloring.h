@@ -0,0 +1,173 @@
+﻿#ifndef _PARALLEL_COLORING_H_
+#define _PARALLEL_COLORING_H_
+
+#include "coloring.h"
+
+#include "../core/parallel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace empire
+{
+
+namespace
+{
+
+constexpr size_t ColoringGrain = 1024;
+
+unsigned coloring_workers(unsigned threads, size_t size)
+{
+	return static_cast<unsigned>(std::min<size_t>(threads, size / ColoringGrain + 1));
+}
+
+uint64_t priority(size_t v, unsigned seed)
+{
+	uint64_t x = (static_cast<uint64_t>(v) << 32) ^ v ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ull);
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdull;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ull;
+	x ^= x >> 33;
+	return x;
+}
+
+} // namespace
+
+// Jones-Plassmann: every round colors the uncolored vertexes whose random
+// priority is higher than the one of all their uncolored neighbours
+Coloring jones_plassmann_coloring(Adjacency const& adjacency,
+	unsigned threads = core::concurrency(), unsigned seed = 0)
+{
+	auto const n = adjacency.size();
+	std::vector<uint64_t> priorities(n);
+	core::parallel_for(0, n, [&](size_t v) { priorities[v] = priority(v, seed); },
+		coloring_workers(threads, n));
+
+	auto higher = [&priorities](size_t a, size_t b)
+	{
+		return priorities[a] > priorities[b] || (priorities[a] == priorities[b] && a > b);
+	};
+
+	Coloring coloring(n, NoColor);
+	std::vector<size_t> uncolored(n);
+	std::iota(std::begin(uncolored), std::end(uncolored), 0);
+	std::vector<char> ready(n, 0);
+	std::vector<ColorMarks> marks(std::max(1u, threads));
+	std::vector<std::vector<size_t>> rest(std::max(1u, threads));
+
+	while (!uncolored.empty())
+	{
+		auto const workers = coloring_workers(threads, uncolored.size());
+		core::parallel_chunks(0, uncolored.size(),
+			[&](size_t, size_t first, size_t last)
+			{
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = uncolored[i];
+					bool top = true;
+					for (auto e = adjacency.offsets[v]; top && e < adjacency.offsets[v + 1]; ++e)
+					{
+						auto const u = adjacency.targets[e];
+						top = coloring[u] != NoColor || higher(v, u);
+					}
+					ready[v] = top;
+				}
+			},
+			workers);
+
+		core::parallel_chunks(0, uncolored.size(),
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = uncolored[i];
+					if (!ready[v])
+					{
+						rest[chunk].push_back(v);
+						continue;
+					}
+					coloring[v] = smallest_free_color(adjacency, coloring, v, marks[chunk]);
+				}
+			},
+			workers);
+
+		uncolored.clear();
+		for (auto& r: rest)
+		{
+			uncolored.insert(std::end(uncolored), std::begin(r), std::end(r));
+			r.clear();
+		}
+	}
+	return coloring;
+}
+
+// Gebremedhin-Manne: colors speculatively in parallel, then recolors
+// the vertexes that got the color of a smaller neighbour
+Coloring speculative_coloring(Adjacency const& adjacency, unsigned threads = core::concurrency())
+{
+	auto const n = adjacency.size();
+	std::vector<std::atomic<int>> colors(n);
+	for (auto& c: colors) c.store(NoColor, std::memory_order_relaxed);
+
+	std::vector<size_t> work(n);
+	std::iota(std::begin(work), std::end(work), 0);
+	std::vector<ColorMarks> marks(std::max(1u, threads));
+	std::vector<std::vector<size_t>> conflicts(std::max(1u, threads));
+
+	auto color_of = [&colors](size_t u) { return colors[u].load(std::memory_order_relaxed); };
+
+	while (!work.empty())
+	{
+		auto const workers = coloring_workers(threads, work.size());
+		core::parallel_chunks(0, work.size(),
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = work[i];
+					colors[v].store(smallest_free_color(adjacency, v, color_of, marks[chunk]),
+						std::memory_order_relaxed);
+				}
+			},
+			workers);
+
+		core::parallel_chunks(0, work.size(),
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = work[i];
+					auto const color = color_of(v);
+					for (auto e = adjacency.offsets[v]; e < adjacency.offsets[v + 1]; ++e)
+					{
+						auto const u = adjacency.targets[e];
+						if (u < v && color_of(u) == color)
+						{
+							conflicts[chunk].push_back(v);
+							break;
+						}
+					}
+				}
+			},
+			workers);
+
+		work.clear();
+		for (auto& c: conflicts)
+		{
+			work.insert(std::end(work), std::begin(c), std::end(c));
+			c.clear();
+		}
+		for (auto v: work) colors[v].store(NoColor, std::memory_order_relaxed);
+	}
+
+	Coloring coloring(n);
+	for (size_t v = 0; v < n; ++v) coloring[v] = colors[v].load(std::memory_order_relaxed);
+	return coloring;
+}
+
+} // namespace empire
+
+#endif // _PARALLEL_COLORING_H_
@@ -0,0 +1,82 @@
+﻿#ifndef _PATH_CACHE_H_
+#define _PATH_CACHE_H_
+
+#include "csr.h"
+#include "dijkstra.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace empire
+{
+
+// Shortest path trees of the recently asked sources, the least recently
+// used tree is dropped when the cache is full. The graph must not change
+// while the cache is used, clear() forgets the trees
+template<typename T>
+class PathCache
+{
+public:
+	using node_type = typename T::node_type;
+	using link_type = typename T::link_type;
+	using cost_type = typename link_type::cost_type;
+
+	explicit PathCache(T const& graph, size_t capacity = 16): csr_{make_csr(graph)}, capacity_{capacity} {}
+
+	std::vector<link_type*> find_path(node_type const* from, node_type const* to)
+	{
+		return tree_path(csr_, tree(csr_.id(from)), csr_.id(to));
+	}
+
+	cost_type distance(node_type const* from, node_type const* to)
+	{
+		return tree(csr_.id(from)).distances[csr_.id(to)];
+	}
+
+	size_t hits() const { return hits_; }
+	size_t misses() const { return misses_; }
+
+	void clear()
+	{
+		trees_.clear();
+		index_.clear();
+	}
+
+private:
+	using Tree = ShortestPathTree<cost_type>;
+
+	Tree const& tree(size_t source);
+
+	Csr<T> csr_;
+	size_t capacity_;
+	std::list<Tree> trees_;
+	std::unordered_map<size_t, typename std::list<Tree>::iterator> index_;
+	size_t hits_{0};
+	size_t misses_{0};
+};
+
+template<typename T>
+typename PathCache<T>::Tree const& PathCache<T>::tree(size_t source)
+{
+	if (auto found = index_.find(source); found != std::end(index_))
+	{
+		++hits_;
+		trees_.splice(std::begin(trees_), trees_, found->second);
+		return trees_.front();
+	}
+
+	++misses_;
+	if (capacity_ > 0 && trees_.size() == capacity_)
+	{
+		index_.erase(trees_.back().source);
+		trees_.pop_back();
+	}
+	trees_.push_front(shortest_path_tree(csr_, source));
+	index_.emplace(source, std::begin(trees_));
+	return trees_.front();
+}
+
+} // namespace empire
+
+#endif // _PATH_CACHE_H_
@@ -0,0 +1,233 @@
+﻿#ifndef _SPANNING_TREE_H_
+#define _SPANNING_TREE_H_
+
+#include "components.h"
+#include "csr.h"
+
+#include "../core/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <vector>
+
+namespace empire
+{
+
+// Minimum spanning forest of the graph taken as undirected, links are
+// indexes of Csr::links. Equal costs are ordered by the link index,
+// so all the engines pick the same forest
+template<typename C>
+struct SpanningForest
+{
+	std::vector<size_t> links;
+	C weight{};
+};
+
+namespace
+{
+
+template<typename T>
+struct WeightedLinks
+{
+	using cost_type = typename Csr<T>::cost_type;
+
+	std::vector<size_t> sources;
+	std::vector<size_t> const& targets;
+	std::vector<cost_type> costs;
+
+	explicit WeightedLinks(Csr<T> const& csr): sources(csr.edges()), targets{csr.targets}, costs(csr.edges())
+	{
+		core::parallel_for(0, csr.size(),
+			[this, &csr](size_t v)
+			{
+				for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+				{
+					sources[e] = v;
+					costs[e] = csr.links[e]->cost;
+				}
+			});
+	}
+
+	bool lighter(size_t a, size_t b) const
+	{
+		return costs[a] < costs[b] || (!(costs[b] < costs[a]) && a < b);
+	}
+};
+
+template<typename C, typename T>
+SpanningForest<C> make_forest(std::vector<size_t> links, WeightedLinks<T> const& weighted)
+{
+	SpanningForest<C> forest;
+	forest.links = std::move(links);
+	for (auto e: forest.links) forest.weight = forest.weight + weighted.costs[e];
+	return forest;
+}
+
+} // namespace
+
+template<typename T>
+SpanningForest<typename Csr<T>::cost_type> kruskal_spanning_tree(Csr<T> const& csr,
+	unsigned threads = core::concurrency())
+{
+	WeightedLinks<T> const weighted{csr};
+	std::vector<size_t> order(csr.edges());
+	std::iota(std::begin(order), std::end(order), 0);
+	core::parallel_sort(std::begin(order), std::end(order),
+		[&weighted](size_t a, size_t b) { return weighted.lighter(a, b); },
+		threads);
+
+	UnionFind sets{csr.size()};
+	std::vector<size_t> links;
+	for (auto e: order)
+	{
+		if (links.size() + 1 >= csr.size()) break;
+		if (sets.unite(weighted.sources[e], weighted.targets[e])) links.push_back(e);
+	}
+	return make_forest<typename Csr<T>::cost_type>(std::move(links), weighted);
+}
+
+// Lazy binary heap of links leaving the tree, links are seen from both ends
+template<typename T>
+SpanningForest<typename Csr<T>::cost_type> prim_spanning_tree(Csr<T> const& csr)
+{
+	WeightedLinks<T> const weighted{csr};
+	auto const n = csr.size();
+
+	std::vector<size_t> offsets(n + 1, 0);
+	for (size_t e = 0; e < csr.edges(); ++e)
+	{
+		++offsets[weighted.sources[e] + 1];
+		++offsets[weighted.targets[e] + 1];
+	}
+	std::partial_sum(std::begin(offsets), std::end(offsets), std::begin(offsets));
+	std::vector<size_t> incident(offsets.back());
+	std::vector<size_t> tails(std::begin(offsets), std::end(offsets) - 1);
+	for (size_t e = 0; e < csr.edges(); ++e)
+	{
+		incident[tails[weighted.sources[e]]++] = e;
+		incident[tails[weighted.targets[e]]++] = e;
+	}
+
+	auto heavier = [&weighted](size_t a, size_t b) { return weighted.lighter(b, a); };
+	std::priority_queue<size_t, std::vector<size_t>, decltype(heavier)> heap{heavier};
+	std::vector<bool> in_tree(n, false);
+	std::vector<size_t> links;
+
+	auto add = [&](size_t v)
+	{
+		in_tree[v] = true;
+		for (auto i = offsets[v]; i < offsets[v + 1]; ++i)
+		{
+			auto const e = incident[i];
+			auto const u = weighted.sources[e] == v ? weighted.targets[e] : weighted.sources[e];
+			if (!in_tree[u]) heap.push(e);
+		}
+	};
+
+	for (size_t root = 0; root < n; ++root)
+	{
+		if (in_tree[root]) continue;
+		add(root);
+		while (!heap.empty())
+		{
+			auto const e = heap.top();
+			heap.pop();
+			auto const s = weighted.sources[e];
+			auto const t = weighted.targets[e];
+			if (in_tree[s] && in_tree[t]) continue;
+			links.push_back(e);
+			add(in_tree[s] ? t : s);
+		}
+	}
+	return make_forest<typename Csr<T>::cost_type>(std::move(links), weighted);
+}
+
+// Every round each component picks its lightest outgoing link with an
+// atomic minimum, the picked links are joined with the concurrent
+// union-find and the links inside components are dropped
+template<typename T>
+SpanningForest<typename Csr<T>::cost_type> boruvka_spanning_tree(Csr<T> const& csr,
+	unsigned threads = core::concurrency())
+{
+	WeightedLinks<T> const weighted{csr};
+	auto const n = csr.size();
+	ConcurrentUnionFind sets{n};
+	std::vector<std::atomic<size_t>> best(n);
+
+	auto const workers = std::max(1u, threads);
+	std::vector<std::vector<size_t>> picked(workers);
+	std::vector<std::vector<size_t>> kept(workers);
+
+	std::vector<size_t> live;
+	live.reserve(csr.edges());
+	for (size_t e = 0; e < csr.edges(); ++e)
+	{
+		if (weighted.sources[e] != weighted.targets[e]) live.push_back(e);
+	}
+
+	auto join = [](std::vector<std::vector<size_t>>& parts, std::vector<size_t>& to)
+	{
+		to.clear();
+		for (auto& p: parts)
+		{
+			to.insert(std::end(to), std::begin(p), std::end(p));
+			p.clear();
+		}
+	};
+
+	std::vector<size_t> links;
+	std::vector<size_t> round;
+	while (!live.empty())
+	{
+		core::parallel_for(0, n, [&best](size_t v) { best[v].store(NoLink, std::memory_order_relaxed); }, workers);
+
+		core::parallel_for(0, live.size(),
+			[&](size_t i)
+			{
+				auto const e = live[i];
+				for (auto c: {sets.find(weighted.sources[e]), sets.find(weighted.targets[e])})
+				{
+					auto current = best[c].load(std::memory_order_relaxed);
+					while ((current == NoLink || weighted.lighter(e, current)) &&
+						!best[c].compare_exchange_weak(current, e, std::memory_order_relaxed)) {}
+				}
+			},
+			workers);
+
+		core::parallel_chunks(0, n,
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				for (auto v = first; v < last; ++v)
+				{
+					auto const e = best[v].load(std::memory_order_relaxed);
+					if (e != NoLink && sets.unite(weighted.sources[e], weighted.targets[e]))
+						picked[chunk].push_back(e);
+				}
+			},
+			workers);
+		join(picked, round);
+		if (round.empty()) break;
+		links.insert(std::end(links), std::begin(round), std::end(round));
+
+		core::parallel_chunks(0, live.size(),
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				for (auto i = first; i < last; ++i)
+				{
+					auto const e = live[i];
+					if (sets.find(weighted.sources[e]) != sets.find(weighted.targets[e]))
+						kept[chunk].push_back(e);
+				}
+			},
+			workers);
+		join(kept, live);
+	}
+	return make_forest<typename Csr<T>::cost_type>(std::move(links), weighted);
+}
+
+} // namespace empire
+
+#endif // _SPANNING_TREE_H_
@@ -1,47 +1,264 @@
 ﻿#ifndef _TOPOLOGIC_H_
 #define _TOPOLOGIC_H_
 
+#include "csr.h"
 #include "graph.h"
 
+#include "../core/parallel.h"
+
+#include <atomic>
+#include <vector>
+
 namespace empire
 {
 
 template<typename T>
-std::vector<typename T::node_type*> topologic_sort(T const& graph)
+using Levels = std::vector<std::vector<T*>>;
+
+template<typename T>
+struct Schedule
 {
 	using node_type = typename T::node_type;
 
-	std::unordered_map<node_type const*, int> dependencies;
-	dependencies.reserve(graph.size());
+	Levels<node_type> levels;
+	std::vector<node_type*> cycle;
+
+	bool is_acyclic() const { return cycle.empty(); }
+};
+
+namespace
+{
+
+constexpr size_t TopologicGrain = 256;
+
+template<typename T>
+std::vector<int> count_dependencies(Csr<T> const& csr)
+{
+	std::vector<int> dependencies(csr.size(), 0);
+	for (auto to: csr.targets) ++dependencies[to];
+	return dependencies;
+}
+
+template<typename T>
+std::vector<typename T::node_type*>
+to_nodes(Csr<T> const& csr, std::vector<size_t> const& ids)
+{
+	std::vector<typename T::node_type*> nodes;
+	nodes.reserve(ids.size());
+	for (auto v: ids) nodes.push_back(csr.nodes[v]);
+	return nodes;
+}
+
+template<typename T>
+bool has_loop(Csr<T> const& csr, size_t v)
+{
+	for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+	{
+		if (csr.targets[e] == v) return true;
+	}
+	return false;
+}
+
+// Tarjan's algorithm over alive nodes, returns the first component having a cycle
+template<typename T>
+std::vector<typename T::node_type*>
+strong_component(Csr<T> const& csr, std::vector<bool> const& alive)
+{
+	constexpr auto none = std::numeric_limits<size_t>::max();
+	auto const n = csr.size();
 
-	for (auto const& n: graph)
-		for (auto const& l: n->links)
-			++dependencies[l.to];
+	std::vector<size_t> index(n, none);
+	std::vector<size_t> low(n, none);
+	std::vector<bool> on_stack(n, false);
+	std::vector<size_t> stack;
+	std::vector<std::pair<size_t, size_t>> frames;
+	size_t counter = 0;
 
-	std::queue<node_type*> ready;
-	for (auto const& n: graph)
-		if (dependencies[n.get()] == 0) ready.push(n.get());
-	 
-	std::vector<node_type*> ordering;
-	while (!ready.empty())
+	auto open = [&](size_t v)
 	{
-		auto n = ready.front();
-		ready.pop();
-		ordering.push_back(n);
-		for (auto const& l: n->links)
+		index[v] = low[v] = counter++;
+		stack.push_back(v);
+		on_stack[v] = true;
+		frames.emplace_back(v, csr.offsets[v]);
+	};
+
+	for (size_t s = 0; s < n; ++s)
+	{
+		if (!alive[s] || index[s] != none) continue;
+		open(s);
+		while (!frames.empty())
 		{
-			--dependencies[l.to];
-			if (dependencies[l.to] == 0) ready.push(l.to);
+			auto const v = frames.back().first;
+			auto& e = frames.back().second;
+			if (e < csr.offsets[v + 1])
+			{
+				auto const w = csr.targets[e++];
+				if (!alive[w]) continue;
+				if (index[w] == none) open(w);
+				else if (on_stack[w]) low[v] = std::min(low[v], index[w]);
+				continue;
+			}
+
+			frames.pop_back();
+			if (!frames.empty())
+			{
+				auto const parent = frames.back().first;
+				low[parent] = std::min(low[parent], low[v]);
+			}
+			if (low[v] != index[v]) continue;
+
+			std::vector<size_t> component;
+			size_t w = none;
+			do
+			{
+				w = stack.back();
+				stack.pop_back();
+				on_stack[w] = false;
+				component.push_back(w);
+			}
+			while (w != v);
+
+			if (component.size() > 1 || has_loop(csr, v))
+			{
+				std::reverse(std::begin(component), std::end(component));
+				return to_nodes(csr, component);
+			}
 		}
 	}
-	if (std::any_of(
-		std::begin(dependencies),
-		std::end(dependencies),
-		[](auto const& p) { return p.second > 0; }))
+	return {};
+}
+
+template<typename T>
+std::vector<typename T::node_type*>
+blocked_cycle(Csr<T> const& csr, std::vector<int> const& dependencies)
+{
+	std::vector<bool> alive(csr.size());
+	for (size_t v = 0; v < csr.size(); ++v) alive[v] = dependencies[v] > 0;
+	return strong_component(csr, alive);
+}
+
+} // namespace
+
+template<typename T>
+std::vector<typename T::node_type*> topologic_sort(T const& graph)
+{
+	auto const csr = make_csr(graph);
+	auto dependencies = count_dependencies(csr);
+
+	std::vector<size_t> ordering;
+	ordering.reserve(csr.size());
+	for (size_t v = 0; v < csr.size(); ++v)
+		if (dependencies[v] == 0) ordering.push_back(v);
+
+	for (size_t head = 0; head < ordering.size(); ++head)
 	{
-		return {};
+		auto const v = ordering[head];
+		for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+		{
+			auto const to = csr.targets[e];
+			if (--dependencies[to] == 0) ordering.push_back(to);
+		}
 	}
-	return ordering;
+	if (ordering.size() != csr.size()) return {};
+	return to_nodes(csr, ordering);
+}
+
+template<typename T>
+Schedule<T> topologic_levels(T const& graph)
+{
+	auto const csr = make_csr(graph);
+	auto dependencies = count_dependencies(csr);
+
+	std::vector<size_t> frontier;
+	for (size_t v = 0; v < csr.size(); ++v)
+		if (dependencies[v] == 0) frontier.push_back(v);
+
+	Schedule<T> schedule;
+	size_t ordered = 0;
+	std::vector<size_t> next;
+	while (!frontier.empty())
+	{
+		ordered += frontier.size();
+		schedule.levels.push_back(to_nodes(csr, frontier));
+		next.clear();
+		for (auto v: frontier)
+		{
+			for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+			{
+				auto const to = csr.targets[e];
+				if (--dependencies[to] == 0) next.push_back(to);
+			}
+		}
+		std::swap(frontier, next);
+	}
+	if (ordered != csr.size()) schedule.cycle = blocked_cycle(csr, dependencies);
+	return schedule;
+}
+
+template<typename T>
+Schedule<T> parallel_topologic_levels(T const& graph, unsigned threads = core::concurrency())
+{
+	auto const csr = make_csr(graph);
+	std::vector<std::atomic<int>> dependencies(csr.size());
+	for (auto& d: dependencies) d.store(0, std::memory_order_relaxed);
+
+	auto workers = [threads](size_t size)
+	{
+		return static_cast<unsigned>(std::min<size_t>(threads, size / TopologicGrain + 1));
+	};
+
+	core::parallel_for(0, csr.edges(),
+		[&](size_t e) { dependencies[csr.targets[e]].fetch_add(1, std::memory_order_relaxed); },
+		workers(csr.edges()));
+
+	std::vector<size_t> frontier;
+	for (size_t v = 0; v < csr.size(); ++v)
+		if (dependencies[v].load(std::memory_order_relaxed) == 0) frontier.push_back(v);
+
+	Schedule<T> schedule;
+	size_t ordered = 0;
+	std::vector<std::vector<size_t>> next(std::max(1u, threads));
+	while (!frontier.empty())
+	{
+		ordered += frontier.size();
+		schedule.levels.push_back(to_nodes(csr, frontier));
+		core::parallel_chunks(0, frontier.size(),
+			[&](size_t chunk, size_t first, size_t last)
+			{
+				auto& ready = next[chunk];
+				for (auto i = first; i < last; ++i)
+				{
+					auto const v = frontier[i];
+					for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+					{
+						auto const to = csr.targets[e];
+						if (dependencies[to].fetch_sub(1, std::memory_order_acq_rel) == 1)
+							ready.push_back(to);
+					}
+				}
+			},
+			workers(frontier.size()));
+
+		frontier.clear();
+		for (auto& ready: next)
+		{
+			frontier.insert(std::end(frontier), std::begin(ready), std::end(ready));
+			ready.clear();
+		}
+	}
+	if (ordered != csr.size())
+	{
+		std::vector<int> blocked(csr.size());
+		for (size_t v = 0; v < csr.size(); ++v) blocked[v] = dependencies[v].load();
+		schedule.cycle = blocked_cycle(csr, blocked);
+	}
+	return schedule;
+}
+
+template<typename T>
+std::vector<typename T::node_type*> find_cycle(T const& graph)
+{
+	return topologic_levels(graph).cycle;
 }
 
 } // namespace empire
@@ -0,0 +1,190 @@
+﻿#ifndef _TOPOLOGIC_ORDER_H_
+#define _TOPOLOGIC_ORDER_H_
+
+#include "csr.h"
+#include "topologic.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace empire
+{
+
+// Pearce-Kelly dynamic topological order, only the region between
+// the ends of an inserted dependency is reordered
+template<typename T>
+class TopologicOrder
+{
+public:
+	using node_type = typename T::node_type;
+
+	explicit TopologicOrder(T const& graph);
+
+	std::vector<node_type*> const& order() const { return order_; }
+	size_t position(node_type const* node) const { return ord_[ids_.at(node)]; }
+	bool precedes(node_type const* a, node_type const* b) const
+	{ return position(a) < position(b); }
+
+	bool insert(node_type const* from, node_type const* to);
+	bool erase(node_type const* from, node_type const* to);
+
+private:
+	using Ids = std::vector<size_t>;
+
+	bool forward(size_t y, size_t upper, Ids& visited);
+	void backward(size_t x, size_t lower, Ids& visited);
+	void reorder(Ids& forward, Ids& backward);
+	void clear(Ids const& visited);
+
+	std::unordered_map<node_type const*, size_t> ids_;
+	std::vector<Ids> out_;
+	std::vector<Ids> in_;
+	std::vector<node_type*> nodes_;
+	std::vector<node_type*> order_;
+	std::vector<size_t> ord_;
+	std::vector<bool> visited_;
+	Ids stack_;
+};
+
+template<typename T>
+TopologicOrder<T>::TopologicOrder(T const& graph)
+{
+	auto csr = make_csr(graph);
+	auto const n = csr.size();
+
+	out_.resize(n);
+	in_.resize(n);
+	for (size_t v = 0; v < n; ++v)
+	{
+		for (auto e = csr.offsets[v]; e < csr.offsets[v + 1]; ++e)
+		{
+			out_[v].push_back(csr.targets[e]);
+			in_[csr.targets[e]].push_back(v);
+		}
+	}
+
+	order_ = topologic_sort(graph);
+	if (order_.size() != n) throw std::runtime_error{"graph has a cycle"};
+
+	ord_.resize(n);
+	for (size_t i = 0; i < n; ++i) ord_[csr.id(order_[i])] = i;
+	visited_.assign(n, false);
+	ids_ = std::move(csr.ids);
+	nodes_ = std::move(csr.nodes);
+}
+
+template<typename T>
+bool TopologicOrder<T>::insert(node_type const* from, node_type const* to)
+{
+	auto const x = ids_.at(from);
+	auto const y = ids_.at(to);
+	if (x == y) return false;
+
+	auto const lower = ord_[y];
+	auto const upper = ord_[x];
+	if (lower < upper)
+	{
+		Ids delta_forward;
+		if (!forward(y, upper, delta_forward))
+		{
+			clear(delta_forward);
+			return false;
+		}
+		Ids delta_backward;
+		backward(x, lower, delta_backward);
+		reorder(delta_forward, delta_backward);
+	}
+
+	out_[x].push_back(y);
+	in_[y].push_back(x);
+	return true;
+}
+
+template<typename T>
+bool TopologicOrder<T>::erase(node_type const* from, node_type const* to)
+{
+	auto const x = ids_.at(from);
+	auto const y = ids_.at(to);
+	auto found = std::find(std::begin(out_[x]), std::end(out_[x]), y);
+	if (found == std::end(out_[x])) return false;
+	out_[x].erase(found);
+	in_[y].erase(std::find(std::begin(in_[y]), std::end(in_[y]), x));
+	return true;
+}
+
+template<typename T>
+bool TopologicOrder<T>::forward(size_t y, size_t upper, Ids& visited)
+{
+	stack_.assign(1, y);
+	visited_[y] = true;
+	visited.push_back(y);
+	while (!stack_.empty())
+	{
+		auto const v = stack_.back();
+		stack_.pop_back();
+		for (auto w: out_[v])
+		{
+			if (ord_[w] == upper) return false;
+			if (visited_[w] || ord_[w] > upper) continue;
+			visited_[w] = true;
+			visited.push_back(w);
+			stack_.push_back(w);
+		}
+	}
+	return true;
+}
+
+template<typename T>
+void TopologicOrder<T>::backward(size_t x, size_t lower, Ids& visited)
+{
+	stack_.assign(1, x);
+	visited_[x] = true;
+	visited.push_back(x);
+	while (!stack_.empty())
+	{
+		auto const v = stack_.back();
+		stack_.pop_back();
+		for (auto w: in_[v])
+		{
+			if (visited_[w] || ord_[w] < lower) continue;
+			visited_[w] = true;
+			visited.push_back(w);
+			stack_.push_back(w);
+		}
+	}
+}
+
+template<typename T>
+void TopologicOrder<T>::reorder(Ids& forward, Ids& backward)
+{
+	auto by_order = [this](size_t a, size_t b) { return ord_[a] < ord_[b]; };
+	std::sort(std::begin(forward), std::end(forward), by_order);
+	std::sort(std::begin(backward), std::end(backward), by_order);
+
+	Ids positions;
+	positions.reserve(forward.size() + backward.size());
+	for (auto v: backward) positions.push_back(ord_[v]);
+	for (auto v: forward) positions.push_back(ord_[v]);
+	std::sort(std::begin(positions), std::end(positions));
+
+	size_t i = 0;
+	for (auto v: backward) ord_[v] = positions[i++];
+	for (auto v: forward) ord_[v] = positions[i++];
+
+	for (auto v: backward) order_[ord_[v]] = nodes_[v];
+	for (auto v: forward) order_[ord_[v]] = nodes_[v];
+	clear(backward);
+	clear(forward);
+}
+
+template<typename T>
+void TopologicOrder<T>::clear(Ids const& visited)
+{
+	for (auto v: visited) visited_[v] = false;
+}
+
+} // namespace empire
+
+#endif // _TOPOLOGIC_ORDER_H_
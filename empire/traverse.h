@@ -1,11 +1,13 @@
 ﻿#ifndef _TRAVERSE_H_
 #define _TRAVERSE_H_
 
+#include <algorithm>
 #include <list>
 #include <stack>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace empire
 {
@@ -0,0 +1,55 @@
+﻿#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "core/profiler.h"
+#include "empire/analytics.h"
+#include "empire/csr.h"
+#include "empire/graph.h"
+
+empire::Graph<int> random_graph(size_t n, size_t m)
+{
+	std::default_random_engine engine{42};
+	std::uniform_int_distribution<size_t> node{0, n - 1};
+	std::vector<empire::MetaLink<>> links;
+	links.reserve(m);
+	for (size_t i = 0; i < m; ++i) links.push_back({node(engine), node(engine), 1});
+	return empire::make_graph(std::vector<int>(n), std::move(links));
+}
+
+int main(int argc, char* argv[])
+{
+	size_t const n = argc > 1 ? std::atol(argv[1]) : 1000000;
+	size_t const m = argc > 2 ? std::atol(argv[2]) : 10000000;
+	std::cout << core::concurrency() << " threads\n";
+
+	{
+		auto const graph = random_graph(n, m);
+		auto const csr = empire::make_csr(graph);
+
+		core::WallProfiler rank_profiler;
+		auto const rank = empire::page_rank(csr);
+		std::cout << "page rank " << n << '/' << m << ": " << rank.iterations << " iterations, "
+			<< rank_profiler.time_ms() << " ms\n";
+
+		auto const adjacency = empire::make_adjacency(csr);
+		core::WallProfiler core_profiler;
+		auto const cores = empire::core_numbers(adjacency);
+		std::cout << "k-core " << n << '/' << m << ": max core "
+			<< *std::max_element(std::begin(cores), std::end(cores)) << ", "
+			<< core_profiler.time_ms() << " ms\n";
+	}
+
+	{
+		auto const graph = random_graph(n / 200, m / 200);
+		auto const csr = empire::make_csr(graph);
+		core::WallProfiler profiler;
+		auto const centrality = empire::betweenness_centrality(csr);
+		std::cout << "betweenness " << n / 200 << '/' << m / 200 << ": max "
+			<< *std::max_element(std::begin(centrality), std::end(centrality)) << ", "
+			<< profiler.time_ms() << " ms\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+﻿#include <iostream>
+#include <random>
+#include <unordered_set>
+
+#include "core/profiler.h"
+#include "empire/colorizer.h"
+#include "empire/graph.h"
+#include "empire/parallel_coloring.h"
+
+#include "example_graphs.h"
+
+using graph_type = empire::Graph<int>;
+using view_type = empire::GraphView<graph_type>;
+
+graph_type random_graph(int n, int degree)
+{
+	std::default_random_engine engine{42};
+	std::uniform_int_distribution<size_t> random{0, static_cast<size_t>(n) - 1};
+
+	std::vector<int> values(n);
+	std::iota(std::begin(values), std::end(values), 0);
+	std::vector<empire::MetaLink<>> links;
+	links.reserve(static_cast<size_t>(n) * degree);
+	for (int i = 0; i < n * degree / 2; ++i)
+	{
+		auto const from = random(engine);
+		auto const to = random(engine);
+		if (from == to) continue;
+		links.push_back({from, to});
+		links.push_back({to, from});
+	}
+	return empire::make_graph(values, links);
+}
+
+size_t count_colors(view_type const& view)
+{
+	std::unordered_set<int> colors;
+	for (auto const& [n, v]: view.vertexes) colors.insert(v.style.background.r);
+	return colors.size();
+}
+
+template<typename F>
+void measure(char const* name, view_type& view, Colors const& colors, F&& paint)
+{
+	view.reset_styles();
+	core::WallProfiler profiler;
+	paint(empire::Colorizer{view}, colors);
+	auto const time = profiler.time_ms();
+	std::cout << name << ": " << count_colors(view) << " colors, " << time << " ms\n";
+}
+
+int main()
+{
+	auto const graph = random_graph(200000, 16);
+	auto view = make_view(graph);
+
+	Colors colors;
+	for (int i = 0; i < 256; ++i) colors.push_back({i, 1, 1, 255});
+
+	std::cout << graph.size() << " nodes, " << core::concurrency() << " threads\n";
+	measure("greedy", view, colors,
+		[](auto colorizer, auto const& colors) { colorizer.paint_with(colors); });
+	measure("dsatur", view, colors,
+		[](auto colorizer, auto const& colors) { colorizer.paint_with(colors, empire::dsatur_coloring); });
+	measure("jones-plassmann", view, colors,
+		[](auto colorizer, auto const& colors)
+		{
+			colorizer.paint_with(colors,
+				[](auto const& adjacency) { return empire::jones_plassmann_coloring(adjacency); });
+		});
+	measure("speculative", view, colors,
+		[](auto colorizer, auto const& colors)
+		{
+			colorizer.paint_with(colors,
+				[](auto const& adjacency) { return empire::speculative_coloring(adjacency); });
+		});
+
+	return 0;
+}
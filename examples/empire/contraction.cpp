@@ -0,0 +1,47 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "core/profiler.h"
+#include "empire/contraction.h"
+#include "empire/graph.h"
+
+#include "example_grid.h"
+
+int main(int argc, char* argv[])
+{
+	int const side = argc > 1 ? std::atoi(argv[1]) : 100;
+	int const queries = argc > 2 ? std::atoi(argv[2]) : 50;
+	auto graph = make_grid(side);
+
+	std::default_random_engine engine{11};
+	std::uniform_int_distribution<int> node{0, side * side - 1};
+	std::vector<std::pair<int, int>> pairs;
+	for (int i = 0; i < queries; ++i) pairs.emplace_back(node(engine), node(engine));
+
+	long long costs[3]{};
+	core::WallProfiler traverse_profiler;
+	for (auto [from, to]: pairs) costs[0] += total(graph.find_path(graph[from], graph[to], empire::Traverse::Mark));
+	std::cout << "find_path: " << traverse_profiler.time_ms() << " ms\n";
+
+	core::WallProfiler build_profiler;
+	empire::ContractionHierarchy hierarchy{graph};
+	std::cout << "hierarchy: " << build_profiler.time_ms() << " ms to build, " << hierarchy.shortcuts()
+		<< " shortcuts\n";
+
+	core::WallProfiler query_profiler;
+	for (auto [from, to]: pairs) costs[1] += total(hierarchy.find_path(graph[from], graph[to]));
+	std::cout << "hierarchy: " << query_profiler.time_ms() << " ms\n";
+
+	std::stringstream stream;
+	hierarchy.save(stream);
+	core::WallProfiler load_profiler;
+	empire::ContractionHierarchy loaded{graph, stream};
+	std::cout << "loaded " << stream.str().size() << " bytes: " << load_profiler.time_ms() << " ms\n";
+	for (auto [from, to]: pairs) costs[2] += total(loaded.find_path(graph[from], graph[to]));
+
+	std::cout << "path costs " << costs[0] << ' ' << costs[1] << ' ' << costs[2] << '\n';
+
+	return 0;
+}
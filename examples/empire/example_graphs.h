@@ -0,0 +1,70 @@
+﻿#ifndef _EXAMPLE_GRAPHS_H_
+#define _EXAMPLE_GRAPHS_H_
+
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "empire/graph.h"
+#include "empire/view.h"
+
+// Graphs shared by the benchmarks
+
+// View of every node without placing it, enough for the colorizers
+template<typename G>
+empire::GraphView<G> make_view(G const& graph)
+{
+	empire::GraphView<G> view;
+	view.vertexes.reserve(graph.size());
+	for (auto const& n: graph) view.vertexes.emplace(n.get(), empire::Vertex<typename G::node_type>{n.get()});
+	empire::CreateEdges(view);
+	return view;
+}
+
+// Icosahedron with every face cut in four the given number of times,
+// 10 * 4^k + 2 nodes of degree 5 or 6. Planar with minimum degree 5, so
+// the 5-coloring has no vertex of degree 4 or less to remove
+empire::Graph<int> make_geodesic_sphere(int subdivisions)
+{
+	using Face = std::array<size_t, 3>;
+	std::vector<Face> faces{
+		{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+		{1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+		{3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+		{4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+	size_t nodes = 12;
+
+	for (int i = 0; i < subdivisions; ++i)
+	{
+		std::map<std::pair<size_t, size_t>, size_t> middles;
+		auto middle = [&middles, &nodes](size_t a, size_t b)
+		{
+			auto const [it, added] = middles.try_emplace(std::minmax(a, b), nodes);
+			if (added) ++nodes;
+			return it->second;
+		};
+
+		std::vector<Face> divided;
+		divided.reserve(4 * faces.size());
+		for (auto [a, b, c]: faces)
+		{
+			auto const ab = middle(a, b);
+			auto const bc = middle(b, c);
+			auto const ca = middle(c, a);
+			divided.insert(std::end(divided), {{a, ab, ca}, {b, bc, ab}, {c, ca, bc}, {ab, bc, ca}});
+		}
+		faces = std::move(divided);
+	}
+
+	// Faces keep one orientation, so every edge shows up once each way
+	std::vector<empire::MetaLink<>> links;
+	links.reserve(3 * faces.size());
+	for (auto [a, b, c]: faces) links.insert(std::end(links), {{a, b, 1}, {b, c, 1}, {c, a, 1}});
+
+	std::vector<int> values(nodes);
+	for (size_t v = 0; v < nodes; ++v) values[v] = static_cast<int>(v);
+	return empire::make_graph(values, std::move(links));
+}
+
+#endif // _EXAMPLE_GRAPHS_H_
@@ -0,0 +1,37 @@
+﻿#ifndef _EXAMPLE_GRID_H_
+#define _EXAMPLE_GRID_H_
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "empire/graph.h"
+
+// Grid with random costs, the kind of graph the path demo shows
+empire::Graph<int> make_grid(int side)
+{
+	std::default_random_engine engine{7};
+	std::uniform_int_distribution<int> cost{1, 100};
+	std::vector<empire::MetaLink<>> links;
+	for (int y = 0; y < side; ++y)
+	{
+		for (int x = 0; x < side; ++x)
+		{
+			size_t const v = y * side + x;
+			if (x + 1 < side) { links.push_back({v, v + 1, cost(engine)}); links.push_back({v + 1, v, cost(engine)}); }
+			if (y + 1 < side) { links.push_back({v, v + side, cost(engine)}); links.push_back({v + side, v, cost(engine)}); }
+		}
+	}
+	return empire::make_graph(std::vector<int>(side * side), std::move(links));
+}
+
+// Cost of a path as the path finders return it
+template<typename T>
+int total(T const& path)
+{
+	int sum = 0;
+	for (auto link: path) sum += link->cost;
+	return sum;
+}
+
+#endif // _EXAMPLE_GRID_H_
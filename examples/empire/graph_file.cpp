@@ -0,0 +1,34 @@
+﻿#include <iostream>
+#include <sstream>
+
+#include "empire/graph_file.h"
+#include "empire/graph_import.h"
+
+int main()
+{
+	std::istringstream dimacs{
+		"c small road network\n"
+		"p sp 4 5\n"
+		"a 1 2 7\n"
+		"a 1 3 9\n"
+		"a 2 3 10\n"
+		"a 2 4 15\n"
+		"a 3 4 11\n"};
+
+	auto const graph = empire::read_dimacs(dimacs);
+	empire::save_graph("graph.empg", graph);
+
+	empire::GraphFile<size_t> file{"graph.empg"};
+	std::cout << file.size() << " nodes, " << file.edges() << " edges\n";
+	for (size_t v = 0; v < file.size(); ++v)
+	{
+		for (auto e = file.offsets()[v]; e < file.offsets()[v + 1]; ++e)
+			std::cout << file.value(v) << " -> " << file.value(file.targets()[e]) << ": " << file.cost(e) << '\n';
+	}
+
+	auto loaded = file.to_graph();
+	auto const path = loaded.find_path(loaded[0], loaded[3]);
+	std::cout << "path length " << path.size() << '\n';
+
+	return 0;
+}
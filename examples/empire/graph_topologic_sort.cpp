@@ -18,18 +18,25 @@ public:
 private:
 	vertex_type* from_{nullptr};
 
-	using node_type = typename graph_type::node_type; // TODO - use const node_type
-	std::vector<node_type*> path_{empire::topologic_sort(graph())};
+	empire::Schedule<graph_type> schedule_{empire::parallel_topologic_levels(graph())};
 	int next_{0};
 };
 
 void App::OnLoop()
 {
-	if (0 <= next_ && next_ < path_.size())
+	if (0 <= next_ && next_ < schedule_.levels.size())
 	{
-		auto from = path_[next_++];
-		vertex(from).style.border = bwgui::Yellow;
-		vertex(from).style.background = bwgui::Green;
+		for (auto from: schedule_.levels[next_])
+		{
+			vertex(from).style.border = bwgui::Yellow;
+			vertex(from).style.background = bwgui::Green;
+		}
+		++next_;
+	}
+	else if (next_ == schedule_.levels.size())
+	{
+		for (auto from: schedule_.cycle) vertex(from).style.background = bwgui::Red;
+		++next_;
 	}
 }
 
@@ -0,0 +1,49 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "core/profiler.h"
+#include "empire/graph.h"
+#include "empire/landmarks.h"
+#include "empire/path_cache.h"
+
+#include "example_grid.h"
+
+int main(int argc, char* argv[])
+{
+	int const side = argc > 1 ? std::atoi(argv[1]) : 100;
+	int const queries = argc > 2 ? std::atoi(argv[2]) : 50;
+	auto graph = make_grid(side);
+
+	std::default_random_engine engine{11};
+	std::uniform_int_distribution<int> node{0, side * side - 1};
+	std::vector<std::pair<int, int>> pairs;
+	for (int i = 0; i < queries; ++i) pairs.emplace_back(node(engine) % 8, node(engine));
+
+	long long costs[3]{};
+	core::WallProfiler traverse_profiler;
+	for (auto [from, to]: pairs) costs[0] += total(graph.find_path(graph[from], graph[to], empire::Traverse::Mark));
+	std::cout << "find_path: " << traverse_profiler.time_ms() << " ms\n";
+
+	core::WallProfiler cache_profiler;
+	empire::PathCache cache{graph};
+	for (auto [from, to]: pairs) costs[1] += total(cache.find_path(graph[from], graph[to]));
+	std::cout << "cache: " << cache_profiler.time_ms() << " ms, " << cache.hits() << " hits, "
+		<< cache.misses() << " misses\n";
+
+	core::WallProfiler build_profiler;
+	empire::Landmarks landmarks{graph};
+	std::cout << "landmarks: " << build_profiler.time_ms() << " ms to build\n";
+	core::WallProfiler alt_profiler;
+	size_t settled = 0;
+	for (auto [from, to]: pairs)
+	{
+		costs[2] += total(landmarks.find_path(graph[from], graph[to]));
+		settled += landmarks.settled();
+	}
+	std::cout << "alt: " << alt_profiler.time_ms() << " ms, " << settled / queries << " nodes settled per query of "
+		<< side * side << '\n';
+	std::cout << "path costs " << costs[0] << ' ' << costs[1] << ' ' << costs[2] << '\n';
+
+	return 0;
+}
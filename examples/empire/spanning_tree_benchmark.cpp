@@ -0,0 +1,42 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "core/profiler.h"
+#include "empire/csr.h"
+#include "empire/graph.h"
+#include "empire/spanning_tree.h"
+
+template<typename F>
+void measure(char const* name, F&& engine)
+{
+	core::WallProfiler profiler;
+	auto const forest = engine();
+	auto const time = profiler.time_ms();
+	std::cout << name << ": " << forest.links.size() << " links, weight "
+		<< forest.weight << ", " << time << " ms\n";
+}
+
+int main(int argc, char* argv[])
+{
+	size_t const n = argc > 1 ? std::atol(argv[1]) : 1000000;
+	size_t const m = argc > 2 ? std::atol(argv[2]) : 10000000;
+
+	std::default_random_engine engine{42};
+	std::uniform_int_distribution<size_t> node{0, n - 1};
+	std::uniform_int_distribution<long long> cost{1, 1000000};
+
+	std::vector<empire::MetaLink<long long>> links;
+	links.reserve(m);
+	for (size_t i = 0; i < m; ++i) links.push_back({node(engine), node(engine), cost(engine)});
+
+	auto const graph = empire::make_graph(std::vector<int>(n), std::move(links));
+	auto const csr = empire::make_csr(graph);
+	std::cout << n << " nodes, " << m << " links, " << core::concurrency() << " threads\n";
+
+	measure("kruskal", [&csr] { return empire::kruskal_spanning_tree(csr); });
+	measure("prim", [&csr] { return empire::prim_spanning_tree(csr); });
+	measure("boruvka", [&csr] { return empire::boruvka_spanning_tree(csr); });
+
+	return 0;
+}
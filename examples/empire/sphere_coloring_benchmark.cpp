@@ -0,0 +1,35 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <unordered_set>
+
+#include "core/profiler.h"
+#include "empire/colorizer.h"
+
+#include "example_graphs.h"
+
+// 5-coloring of a geodesic sphere, where every simplification step has to
+// merge two neighbours of a vertex of degree 5
+int main(int argc, char* argv[])
+{
+	int const subdivisions = argc > 1 ? std::atoi(argv[1]) : 7;
+	auto const graph = make_geodesic_sphere(subdivisions);
+	auto view = make_view(graph);
+	std::cout << graph.size() << " nodes\n";
+
+	Colors const colors{{255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}, {255, 255, 0, 255}, {0, 255, 255, 255}};
+	view.reset_styles();
+	core::WallProfiler profiler;
+	empire::Colorizer{view}.paint_with(colors[0], colors[1], colors[2], colors[3], colors[4]);
+	auto const time = profiler.time_ms();
+
+	std::unordered_set<int> used;
+	size_t conflicts = 0;
+	for (auto const& [n, v]: view.vertexes)
+	{
+		used.insert(v.style.background.r * 65536 + v.style.background.g * 256 + v.style.background.b);
+		for (auto const& e: v.edges) conflicts += view.vertexes.at(e.link->to).style.background == v.style.background;
+	}
+	std::cout << "5-coloring: " << time << " ms, " << used.size() << " colors, " << conflicts / 2 << " conflicts\n";
+
+	return 0;
+}
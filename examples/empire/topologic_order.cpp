@@ -0,0 +1,39 @@
+﻿#include <iostream>
+
+#include "empire/graph.h"
+#include "empire/topologic_order.h"
+
+template<typename T>
+void print(T const& order)
+{
+	for (auto n: order.order()) std::cout << n->value << ' ';
+	std::cout << '\n';
+}
+
+int main()
+{
+	std::vector<char> values{'A', 'B', 'C', 'D', 'E', 'F'};
+	std::vector<empire::MetaLink<bool>> links
+	{
+		{0, 1}, {1, 2}, {3, 4}
+	};
+
+	auto graph = empire::make_graph(values, links);
+	empire::TopologicOrder order{graph};
+	print(order);
+
+	auto add = [&graph, &order](int from, int to)
+	{
+		std::cout << graph[from]->value << " -> " << graph[to]->value << ": ";
+		if (order.insert(graph[from], graph[to])) print(order);
+		else std::cout << "rejected, cycle\n";
+	};
+
+	add(4, 0);
+	add(2, 3);
+	add(5, 3);
+	add(2, 5);
+	add(1, 4);
+
+	return 0;
+}
@@ -0,0 +1,49 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "core/eratosthenes.h"
+#include "core/parallel.h"
+#include "core/profiler.h"
+#include "empire/all_pairs.h"
+#include "empire/graph.h"
+#include "empire/levels.h"
+
+int main(int argc, char* argv[])
+{
+	long long const number = argc > 1 ? std::atoll(argv[1]) : 100000000;
+	int const nodes = argc > 2 ? std::atoi(argv[2]) : 600;
+	std::cout << "threads: " << core::default_pool().size() + 1 << '\n';
+
+	core::WallProfiler sift_profiler;
+	auto const table = core::sift(number);
+	auto const primes = core::parallel_reduce(size_t{2}, table.size(), size_t{0},
+		[&table](size_t first, size_t last)
+		{
+			size_t count = 0;
+			for (auto i = first; i < last; ++i) count += !table[i];
+			return count;
+		},
+		[](size_t lhs, size_t rhs) { return lhs + rhs; });
+	std::cout << "sift: " << primes << " primes up to " << number << ", " << sift_profiler.time_ms() << " ms\n";
+
+	std::default_random_engine engine{5};
+	std::uniform_int_distribution<size_t> node{0, static_cast<size_t>(nodes) - 1};
+	std::uniform_int_distribution<int> cost{1, 100};
+	std::vector<empire::MetaLink<>> links;
+	for (int i = 0; i < 8 * nodes; ++i) links.push_back({node(engine), node(engine), cost(engine)});
+	auto graph = empire::make_graph(std::vector<int>(nodes), std::move(links));
+
+	core::WallProfiler all_pairs_profiler;
+	empire::AllPairs all_pairs{graph};
+	std::cout << "all pairs: " << all_pairs_profiler.time_ms() << " ms, path of "
+		<< all_pairs.find_path(graph[0], graph[1]).size() << " nodes\n";
+
+	core::WallProfiler levels_profiler;
+	auto const levels = empire::width_levels(graph, graph[0]);
+	size_t reached = 0;
+	for (auto l: levels) reached += l != empire::NoLink;
+	std::cout << "levels: " << reached << " nodes reached, " << levels_profiler.time_ms() << " ms\n";
+
+	return 0;
+}
@@ -0,0 +1,78 @@
+﻿#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+
+#include "core/profiler.h"
+#include "taiga/balanced_tree.h"
+#include "taiga/thread_tree.h"
+
+template<typename F>
+void measure(std::string const& name, F&& func)
+{
+	core::WallProfiler profiler;
+	auto const result = func();
+	std::cout << name << ": " << profiler.time_ms() << " ms (" << result << ")\n";
+}
+
+template<typename L>
+void run(std::string const& name, std::vector<int> const& values, std::vector<int> const& queries)
+{
+	L tree;
+	measure(name + " insert", [&] { for (auto v: values) taiga::add_node(tree, int{v}); return taiga::depth_tree(tree); });
+	measure(name + " find", [&]
+	{
+		size_t found = 0;
+		for (auto q: queries) found += taiga::find_node(tree, q) != nullptr;
+		return found;
+	});
+	measure(name + " erase", [&]
+	{
+		size_t erased = 0;
+		for (auto q: queries) erased += taiga::erase_node(tree, q);
+		return erased;
+	});
+}
+
+void run_map(std::vector<int> const& values, std::vector<int> const& queries)
+{
+	std::map<int, int> map;
+	measure("std::map insert", [&] { for (auto v: values) map.emplace(v, v); return map.size(); });
+	measure("std::map find", [&]
+	{
+		size_t found = 0;
+		for (auto q: queries) found += map.find(q) != std::end(map);
+		return found;
+	});
+	measure("std::map erase", [&]
+	{
+		size_t erased = 0;
+		for (auto q: queries) erased += map.erase(q);
+		return erased;
+	});
+}
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	std::vector<int> sorted(n);
+	std::iota(std::begin(sorted), std::end(sorted), 0);
+	auto shuffled = sorted;
+	std::shuffle(std::begin(shuffled), std::end(shuffled), std::default_random_engine{3});
+	auto queries = shuffled;
+	std::shuffle(std::begin(queries), std::end(queries), std::default_random_engine{5});
+
+	for (auto const* input: {&sorted, &shuffled})
+	{
+		std::cout << (input == &sorted ? "Sorted" : "Shuffled") << " input of " << n << " values\n";
+		run<taiga::RedBlackTree<int>>("red-black", *input, queries);
+		run<taiga::AvlTree<int>>("avl", *input, queries);
+		run<taiga::ThreadTree<int>>("thread avl", *input, queries);
+		run_map(*input, queries);
+	}
+
+	return 0;
+}
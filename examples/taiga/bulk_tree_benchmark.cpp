@@ -0,0 +1,44 @@
+﻿#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+
+#include "core/profiler.h"
+#include "taiga/balanced_tree.h"
+#include "taiga/bulk_tree.h"
+
+template<typename F>
+void measure(std::string const& name, F&& func)
+{
+	core::WallProfiler profiler;
+	auto const depth = func();
+	std::cout << name << ": " << profiler.time_ms() << " ms, depth " << depth << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 4000000;
+	std::vector<int> values(n);
+	std::iota(std::begin(values), std::end(values), 0);
+	std::shuffle(std::begin(values), std::end(values), std::default_random_engine{3});
+	std::cout << n << " shuffled values\n";
+
+	measure("make_tree", [&values] { return taiga::depth_tree(taiga::make_tree(values)); });
+	measure("red-black inserts", [&values]
+	{
+		taiga::RedBlackTree<int> tree;
+		for (auto v: values) taiga::add_node(tree, int{v});
+		return taiga::depth_tree(tree);
+	});
+	measure("make_balanced_tree", [&values] { return taiga::depth_tree(taiga::make_balanced_tree(values)); });
+	measure("make_balanced_tree<Color>", [&values]
+		{ return taiga::depth_tree(taiga::make_balanced_tree<int, taiga::Color>(values)); });
+	measure("make_balanced_thread_tree", [&values] { return taiga::depth_tree(taiga::make_balanced_thread_tree(values)); });
+
+	std::sort(std::begin(values), std::end(values));
+	measure("make_balanced_tree, sorted", [&values] { return taiga::depth_tree(taiga::make_balanced_tree(values)); });
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "core/profiler.h"
+#include "taiga/concurrent_set.h"
+
+// std::set behind a reader-writer lock, the usual way to share one
+class LockedSet
+{
+public:
+	bool contains(int value) const
+	{
+		std::shared_lock lock{mutex_};
+		return set_.count(value) != 0;
+	}
+
+	bool add_value(int value)
+	{
+		std::unique_lock lock{mutex_};
+		return set_.insert(value).second;
+	}
+
+	bool erase_value(int value)
+	{
+		std::unique_lock lock{mutex_};
+		return set_.erase(value) != 0;
+	}
+
+	template<typename F>
+	void for_each_range(int low, int high, F&& func) const
+	{
+		std::shared_lock lock{mutex_};
+		for (auto it = set_.lower_bound(low); it != set_.end() && *it < high; ++it) func(*it);
+	}
+
+private:
+	mutable std::shared_mutex mutex_;
+	std::set<int> set_;
+};
+
+// Readers look values up and scan short ranges, writers add and erase
+// random values, so the set keeps about half of the key space
+template<typename S>
+void run(char const* name, int readers, int writers, int operations, int keys)
+{
+	S set;
+	for (int v = 0; v < keys; v += 2) set.add_value(v);
+
+	std::vector<long long> found(readers + writers);
+	core::WallProfiler profiler;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < readers + writers; ++t)
+	{
+		threads.emplace_back([&set, &found, t, readers, operations, keys]
+		{
+			std::default_random_engine engine(t + 1);
+			std::uniform_int_distribution<int> key{0, keys - 1};
+			for (int i = 0; i < operations; ++i)
+			{
+				auto const v = key(engine);
+				if (t >= readers) (i & 1 ? set.add_value(v) : set.erase_value(v));
+				else if (i % 16 == 0) set.for_each_range(v, v + 64, [&found, t](int) { ++found[t]; });
+				else found[t] += set.contains(v);
+			}
+		});
+	}
+	for (auto& thread: threads) thread.join();
+
+	long long total = 0;
+	for (auto f: found) total += f;
+	std::cout << name << ": " << profiler.time_ms() << " ms, " << total << " found\n";
+}
+
+int main(int argc, char* argv[])
+{
+	int const readers = argc > 1 ? std::atoi(argv[1]) : 6;
+	int const writers = argc > 2 ? std::atoi(argv[2]) : 2;
+	int const operations = argc > 3 ? std::atoi(argv[3]) : 1000000;
+	int const keys = argc > 4 ? std::atoi(argv[4]) : 100000;
+
+	std::cout << readers << " readers, " << writers << " writers, " << operations
+		<< " operations each on " << keys << " keys\n";
+	run<taiga::ConcurrentSet<int>>("ConcurrentSet", readers, writers, operations, keys);
+	run<LockedSet>("std::set + std::shared_mutex", readers, writers, operations, keys);
+
+	return 0;
+}
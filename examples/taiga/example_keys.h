@@ -0,0 +1,27 @@
+﻿#ifndef _EXAMPLE_KEYS_H_
+#define _EXAMPLE_KEYS_H_
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Keys share prefixes the way paths and identifiers do: a few words out
+// of a small vocabulary joined together
+std::vector<std::string> make_keys(int n)
+{
+	std::default_random_engine engine{3};
+	std::vector<std::string> words(64);
+	std::uniform_int_distribution<int> letter{'a', 'z'};
+	std::uniform_int_distribution<int> length{2, 8};
+	for (auto& word: words)
+		for (int i = length(engine); i > 0; --i) word += static_cast<char>(letter(engine));
+
+	std::uniform_int_distribution<size_t> word{0, words.size() - 1};
+	std::uniform_int_distribution<int> parts{1, 5};
+	std::vector<std::string> keys(n);
+	for (auto& key: keys)
+		for (int i = parts(engine); i > 0; --i) key += '/' + words[word(engine)];
+	return keys;
+}
+
+#endif // _EXAMPLE_KEYS_H_
@@ -0,0 +1,48 @@
+﻿#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/profiler.h"
+#include "taiga/frozen_trie.h"
+
+#include "example_keys.h"
+
+template<typename F>
+void measure(std::string const& name, std::vector<std::string> const& keys, F&& find)
+{
+	long long sum = 0;
+	core::WallProfiler profiler;
+	for (auto const& key: keys) sum += *find(key);
+	std::cout << name << " find: " << profiler.time_ms() << " ms (" << sum << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	// Without a path the file goes to the temporary directory and is
+	// removed at the end
+	auto const temporary = argc <= 2;
+	std::string const path = temporary ? (std::filesystem::temp_directory_path() / "frozen_trie.bin").string() : argv[2];
+	auto const keys = make_keys(n);
+
+	auto tree = taiga::make_prefix_node<int>();
+	for (int i = 0; i < n; ++i) taiga::add_value(tree, keys[i], std::optional<int>{i});
+
+	core::WallProfiler freeze_profiler;
+	auto const frozen = taiga::make_frozen_trie(tree);
+	std::cout << "freeze: " << freeze_profiler.time_ms() << " ms, " << frozen.size() << " values in "
+		<< frozen.nodes() << " nodes\n";
+	std::cout << "prefix tree: " << taiga::heap_size(tree) / 1024 << " KB, frozen trie: "
+		<< frozen.image_size() / 1024 << " KB\n";
+	taiga::save_frozen_trie(path, frozen);
+	taiga::FrozenTrie<int> const mapped{path};
+
+	measure("prefix tree", keys, [&tree](std::string const& key) { return taiga::find_value(tree, key); });
+	measure("frozen trie", keys, [&frozen](std::string const& key) { return frozen.find_value(key); });
+	measure("mapped trie", keys, [&mapped](std::string const& key) { return mapped.find_value(key); });
+
+	if (temporary) std::filesystem::remove(path);
+	return 0;
+}
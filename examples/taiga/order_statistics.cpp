@@ -0,0 +1,56 @@
+﻿#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "core/profiler.h"
+#include "taiga/order_statistics.h"
+
+using Tree = taiga::StatisticsTree<int, taiga::SumMonoid<long long>>;
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	int const queries = argc > 2 ? std::atoi(argv[2]) : 1000;
+	std::vector<int> values(n);
+	std::iota(std::begin(values), std::end(values), 0);
+	std::shuffle(std::begin(values), std::end(values), std::default_random_engine{3});
+
+	core::WallProfiler build_profiler;
+	Tree tree;
+	for (auto v: values) taiga::add_node(tree, int{v});
+	std::cout << n << " inserts: " << build_profiler.time_ms() << " ms\n";
+
+	std::default_random_engine engine{5};
+	std::uniform_int_distribution<int> value{0, n};
+	std::vector<std::pair<int, int>> ranges(queries);
+	for (auto& [low, high]: ranges)
+	{
+		low = value(engine);
+		high = value(engine);
+		if (high < low) std::swap(low, high);
+	}
+
+	long long totals[2]{};
+	core::WallProfiler scan_profiler;
+	for (auto [low, high]: ranges)
+	{
+		taiga::symmetric_traverse(tree, [&totals, low = low, high = high](int v)
+		{
+			if (low <= v && v < high) totals[0] += v;
+		});
+	}
+	std::cout << "symmetric_traverse: " << scan_profiler.time_ms() << " ms\n";
+
+	core::WallProfiler aggregate_profiler;
+	for (auto [low, high]: ranges) totals[1] += taiga::aggregate_range(tree, low, high);
+	std::cout << "aggregate_range: " << aggregate_profiler.time_ms() << " ms\n";
+	std::cout << "sums " << totals[0] << ' ' << totals[1] << '\n';
+
+	std::cout << "median " << *taiga::select(tree, n / 2) << ", rank of " << n / 4 << " is "
+		<< taiga::rank(tree, n / 4) << ", " << taiga::count_range(tree, n / 4, n / 2) << " values in ["
+		<< n / 4 << ", " << n / 2 << ")\n";
+
+	return 0;
+}
@@ -12,11 +12,11 @@ void print_debug(taiga::PrefixLink<T> const& link)
 	else
 		std::cout << "null";
 	std::cout << '(';
-	for (auto const& [k, c]: link->children)
+	link->children.for_each([](char k, auto const& c)
 	{
 		std::cout << k << ':';
 		print_debug(c);
-	}
+	});
 	std::cout << ')';
 }
 
@@ -30,12 +30,12 @@ void traverse(taiga::PrefixLink<T> const& link, int level = 0)
 		for (int i = 0; i < level; ++i) std::cout << '\t';
 		std::cout << link->key << '=' << *link->value << '\n';
 	}
-	for (auto const& [k, c]: link->children)
+	link->children.for_each([level](char k, auto const& c)
 	{
 		for (int i = 0; i < level; ++i) std::cout << '\t';
 		std::cout << k << '\n';
 		traverse(c, level + 1);
-	}
+	});
 }
 
 int main()
@@ -49,7 +49,21 @@ int main()
 		{"APE", 60}
 	});
 
-	std::cout << "ANT = " << taiga::find(tree, "ANT") << "\n\n";
+	std::cout << "ANT = " << taiga::find(tree, "ANT") << '\n';
+	std::cout << "BEE " << (taiga::find_value(tree, "BEE") ? "found" : "not found") << '\n';
+
+	auto const match = taiga::longest_prefix_match(tree, "APPLESAUCE");
+	std::cout << "Longest prefix of APPLESAUCE: " << std::string_view{"APPLESAUCE"}.substr(0, match.length)
+		<< " = " << *match.value << '\n';
+
+	std::cout << "Keys starting with AP:";
+	taiga::for_each_with_prefix(tree, "AP", [](std::string_view key, int value)
+	{
+		std::cout << ' ' << key << '=' << value;
+	});
+	std::cout << "\nTop 2 starting with A:";
+	for (auto const& [key, value]: taiga::top_with_prefix(tree, "A", 2)) std::cout << ' ' << key << '=' << value;
+	std::cout << "\n\n";
 
 	print_debug(tree);
 	std::cout << '\n';
@@ -0,0 +1,146 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/profiler.h"
+#include "taiga/prefix_tree.h"
+
+#include "example_keys.h"
+
+// Heap bytes are counted from the layouts: a string outgrowing its
+// inline buffer, and for a hash map its buckets and one node per entry,
+// a lower bound since the nodes of some keys cache the hash as well
+size_t heap_size(std::string const& s)
+{
+	return s.capacity() > std::string{}.capacity() ? s.capacity() + 1 : 0;
+}
+
+template<typename M>
+size_t heap_size(M const& map)
+{
+	return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(void*) + sizeof(typename M::value_type));
+}
+
+// The prefix tree as it was before the adaptive children: a hash map of
+// children in every node, only the leaves keep the rest of their key and
+// find copies the rest of the key at every level
+namespace hashed
+{
+
+struct Node
+{
+	std::string key;
+	std::optional<int> value;
+	std::unordered_map<char, std::unique_ptr<Node>> children;
+};
+
+std::unique_ptr<Node> make_node(std::string_view key, std::optional<int> value)
+{
+	return std::make_unique<Node>(Node{std::string{key}, value, {}});
+}
+
+void push_down(Node& node)
+{
+	node.children[node.key[0]] = make_node(std::string_view{node.key}.substr(1), node.value);
+	node.key.clear();
+	node.value.reset();
+}
+
+void add_value(std::unique_ptr<Node>& link, std::string_view key, std::optional<int> value)
+{
+	if (key == link->key)
+	{
+		link->value = value;
+		return;
+	}
+	if (key.empty())
+	{
+		push_down(*link);
+		link->value = value;
+		return;
+	}
+	if (link->children.empty() && !link->key.empty()) push_down(*link);
+
+	auto found = link->children.find(key[0]);
+	if (found == std::end(link->children)) link->children[key[0]] = make_node(key.substr(1), value);
+	else add_value(found->second, key.substr(1), value);
+}
+
+int find(std::unique_ptr<Node> const& link, std::string const& key)
+{
+	if (key == link->key) return *link->value;
+	auto found = link->children.find(key[0]);
+	if (found == std::end(link->children)) throw std::runtime_error{"not found"};
+	return find(found->second, {key.data() + 1});
+}
+
+size_t heap_size(std::unique_ptr<Node> const& link)
+{
+	auto bytes = sizeof(Node) + ::heap_size(link->key) + ::heap_size(link->children);
+	for (auto const& [c, child]: link->children) bytes += heap_size(child);
+	return bytes;
+}
+
+} // namespace hashed
+
+size_t heap_size(std::unordered_map<std::string, int> const& map)
+{
+	auto bytes = heap_size<std::unordered_map<std::string, int>>(map);
+	for (auto const& [key, value]: map) bytes += heap_size(key);
+	return bytes;
+}
+
+template<typename B, typename F>
+void measure(char const* name, std::vector<std::string> const& keys, B&& build, F&& find)
+{
+	core::WallProfiler build_profiler;
+	auto const index = build(keys);
+	auto const build_time = build_profiler.time_ms();
+
+	long long sum = 0;
+	core::WallProfiler find_profiler;
+	for (auto const& key: keys) sum += find(index, key);
+	std::cout << name << ": build " << build_time << " ms, find " << find_profiler.time_ms() << " ms, "
+		<< heap_size(index) / (1 << 20) << " MB (" << sum << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+	auto const keys = make_keys(n);
+
+	measure("prefix tree", keys,
+		[](auto const& keys)
+		{
+			auto tree = taiga::make_prefix_node<int>();
+			for (size_t i = 0; i < keys.size(); ++i) taiga::add_value(tree, keys[i], std::optional<int>{int(i)});
+			return tree;
+		},
+		[](auto const& tree, std::string const& key) { return *taiga::find_value(tree, key); });
+
+	measure("hash map children", keys,
+		[](auto const& keys)
+		{
+			auto tree = hashed::make_node("", std::nullopt);
+			for (size_t i = 0; i < keys.size(); ++i) hashed::add_value(tree, keys[i], int(i));
+			return tree;
+		},
+		[](auto const& tree, std::string const& key) { return hashed::find(tree, key); });
+
+	measure("std::unordered_map", keys,
+		[](auto const& keys)
+		{
+			std::unordered_map<std::string, int> map;
+			for (size_t i = 0; i < keys.size(); ++i) map[keys[i]] = int(i);
+			return map;
+		},
+		[](auto const& map, std::string const& key) { return map.find(key)->second; });
+
+	return 0;
+}
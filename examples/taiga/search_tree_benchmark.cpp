@@ -0,0 +1,61 @@
+﻿#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+
+#include "core/profiler.h"
+#include "taiga/balanced_tree.h"
+#include "taiga/bplus_tree.h"
+#include "taiga/static_tree.h"
+
+template<typename F>
+void measure(std::string const& name, std::vector<int> const& queries, F&& find)
+{
+	core::WallProfiler profiler;
+	size_t found = 0;
+	for (auto q: queries) found += find(q);
+	std::cout << name << ": " << profiler.time_ms() << " ms, " << found << " found\n";
+}
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 4000000;
+	std::vector<int> values(n);
+	std::iota(std::begin(values), std::end(values), 0);
+	for (auto& v: values) v *= 2;
+	auto shuffled = values;
+	std::shuffle(std::begin(shuffled), std::end(shuffled), std::default_random_engine{3});
+
+	std::default_random_engine engine{5};
+	std::uniform_int_distribution<int> value{0, 2 * n};
+	std::vector<int> queries(n);
+	for (auto& q: queries) q = value(engine);
+
+	taiga::RedBlackTree<int> red_black;
+	std::set<int> set;
+	taiga::BPlusTree<int> bplus;
+	for (auto v: shuffled)
+	{
+		taiga::add_node(red_black, int{v});
+		set.insert(v);
+		bplus.add_value(v);
+	}
+	auto const eytzinger = taiga::make_static_tree(values);
+	std::cout << n << " values, b+ tree depth " << bplus.depth() << '\n';
+
+	measure("std::set", queries, [&set](int q) { return set.count(q); });
+	measure("red-black", queries, [&red_black](int q) { return taiga::find_node(red_black, q) != nullptr; });
+	measure("b+ tree", queries, [&bplus](int q) { return bplus.find(q) != nullptr; });
+	measure("eytzinger", queries, [&eytzinger](int q) { return eytzinger.find(q) != nullptr; });
+	measure("sorted vector", queries, [&values](int q) { return std::binary_search(std::begin(values), std::end(values), q); });
+
+	long long sum = 0;
+	core::WallProfiler scan_profiler;
+	taiga::symmetric_traverse<int>(bplus, [&sum](int v) { sum += v; });
+	std::cout << "b+ tree scan: " << scan_profiler.time_ms() << " ms, sum " << sum << '\n';
+
+	return 0;
+}
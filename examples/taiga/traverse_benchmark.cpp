@@ -0,0 +1,51 @@
+﻿#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "core/profiler.h"
+#include "taiga/tree.h"
+
+// Balanced tree over [first, last)
+taiga::Tree<int> build(int first, int last)
+{
+	if (first >= last) return {};
+	auto const middle = first + (last - first) / 2;
+	auto node = taiga::make_node(int{middle});
+	node->left = build(first, middle);
+	node->right = build(middle + 1, last);
+	return node;
+}
+
+// The traversal as it was: recursion and a std::function copied per level
+void recursive_symmetric_traverse(taiga::Tree<int> const& link, taiga::TraverseFunctor<int> func)
+{
+	if (link->left) recursive_symmetric_traverse(link->left, func);
+	func(link->value);
+	if (link->right) recursive_symmetric_traverse(link->right, func);
+}
+
+template<typename F>
+void measure(std::string const& name, F&& func)
+{
+	long long sum = 0;
+	core::WallProfiler profiler;
+	func(sum);
+	std::cout << name << ": " << profiler.time_ms() << " ms, sum " << sum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+	int const n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+	auto const tree = build(0, n);
+	std::cout << n << " nodes, depth " << taiga::depth_tree(tree) << '\n';
+
+	measure("recursive std::function", [&tree](long long& sum)
+		{ recursive_symmetric_traverse(tree, [&sum](int v) { sum += v; }); });
+	measure("forward", [&tree](long long& sum) { taiga::forward_traverse(tree, [&sum](int v) { sum += v; }); });
+	measure("symmetric", [&tree](long long& sum) { taiga::symmetric_traverse(tree, [&sum](int v) { sum += v; }); });
+	measure("backward", [&tree](long long& sum) { taiga::backward_traverse(tree, [&sum](int v) { sum += v; }); });
+	measure("symmetric iterator", [&tree](long long& sum) { for (auto v: taiga::symmetric_range(tree)) sum += v; });
+	measure("backward iterator", [&tree](long long& sum) { for (auto v: taiga::backward_range(tree)) sum += v; });
+
+	return 0;
+}
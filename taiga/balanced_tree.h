@@ -0,0 +1,331 @@
+﻿#ifndef _BALANCED_TREE_H_
+#define _BALANCED_TREE_H_
+
+#include "tree.h"
+
+#include <array>
+#include <utility>
+
+namespace taiga
+{
+
+// Balance data takes the place of the thread of the node, so balanced
+// trees keep the Node/Link shape and all the traversals of tree.h
+struct Color
+{
+	bool red{true};
+};
+
+struct Height
+{
+	int height{1};
+};
+
+template<typename T>
+using RedBlackTree = Link<T, Color>;
+
+template<typename T>
+using AvlTree = Link<T, Height>;
+
+template<typename T, typename U = Thread>
+Node<T, U> const* find_node(Link<T, U> const& link, T const& value)
+{
+	auto node = link.get();
+	while (node)
+	{
+		if (value < node->value) node = node->left.get();
+		else if (node->value < value) node = node->right.get();
+		else return node;
+	}
+	return nullptr;
+}
+
+// The link keeps its place in the parent, the node under it changes
+template<typename T, typename U = Thread>
+void rotate_left(Link<T, U>& link)
+{
+	auto right = std::move(link->right);
+	link->right = std::move(right->left);
+	right->left = std::move(link);
+	link = std::move(right);
+}
+
+template<typename T, typename U = Thread>
+void rotate_right(Link<T, U>& link)
+{
+	auto left = std::move(link->left);
+	link->left = std::move(left->right);
+	left->right = std::move(link);
+	link = std::move(left);
+}
+
+namespace
+{
+
+// Links from the root down to the current node, deep enough for
+// any balanced tree that fits in memory
+template<typename T, typename U>
+struct TreePath
+{
+	std::array<Link<T, U>*, 160> links;
+	size_t size{0};
+
+	void push(Link<T, U>* link) { links[size++] = link; }
+	Link<T, U>& operator[](size_t i) const { return *links[i]; }
+	Link<T, U>& back() const { return *links[size - 1]; }
+};
+
+// Walks down to the empty link where the value goes, equal values go right
+template<typename T, typename U>
+void path_to_leaf(TreePath<T, U>& path, Link<T, U>& tree, T const& value)
+{
+	path.push(&tree);
+	while (path.back())
+	{
+		auto& node = *path.back();
+		path.push(value < node.value ? &node.left : &node.right);
+	}
+}
+
+template<typename T, typename U>
+bool path_to_value(TreePath<T, U>& path, Link<T, U>& tree, T const& value)
+{
+	path.push(&tree);
+	while (path.back())
+	{
+		auto& node = *path.back();
+		if (value < node.value) path.push(&node.left);
+		else if (node.value < value) path.push(&node.right);
+		else return true;
+	}
+	return false;
+}
+
+// Moves the value of the smallest node of the right subtree into the
+// erased node, the path ends at the link of the node left to unlink
+template<typename T, typename U>
+void path_to_successor(TreePath<T, U>& path)
+{
+	auto& erased = *path.back();
+	if (!erased.left || !erased.right) return;
+	path.push(&erased.right);
+	while (path.back()->left) path.push(&path.back()->left);
+	std::swap(erased.value, path.back()->value);
+}
+
+template<typename T, typename U>
+Link<T, U> unlink_node(Link<T, U>& link)
+{
+	auto child = link->left ? std::move(link->left) : std::move(link->right);
+	auto node = std::move(link);
+	link = std::move(child);
+	return node;
+}
+
+template<typename T>
+bool is_red(RedBlackTree<T> const& link) { return link && link->thread.red; }
+
+template<typename T, typename U>
+int height(Link<T, U> const& link) { return link ? link->thread.height : 0; }
+
+} // namespace
+
+// Recomputes the data of an AVL node from its children, variants that
+// keep more than the height overload it
+template<typename T>
+void update_node(Node<T, Height>& node)
+{
+	node.thread.height = 1 + std::max(height(node.left), height(node.right));
+}
+
+namespace
+{
+
+template<typename T, typename U>
+void rebalance(Link<T, U>& link)
+{
+	update_node(*link);
+	auto const balance = height(link->left) - height(link->right);
+	if (balance > 1)
+	{
+		if (height(link->left->left) < height(link->left->right))
+		{
+			rotate_left(link->left);
+			update_node(*link->left->left);
+		}
+		rotate_right(link);
+		update_node(*link->right);
+		update_node(*link);
+	}
+	else if (balance < -1)
+	{
+		if (height(link->right->right) < height(link->right->left))
+		{
+			rotate_right(link->right);
+			update_node(*link->right->right);
+		}
+		rotate_left(link);
+		update_node(*link->left);
+		update_node(*link);
+	}
+}
+
+// AVL insert and erase, every node on the path is updated
+template<typename T, typename U>
+void avl_add(Link<T, U>& tree, T&& value)
+{
+	TreePath<T, U> path;
+	path_to_leaf(path, tree, value);
+	path.back() = make_node<T, U>(std::forward<T>(value));
+	update_node(*path.back());
+	for (auto i = path.size - 1; i-- > 0;) rebalance(path[i]);
+}
+
+template<typename T, typename U>
+bool avl_erase(Link<T, U>& tree, T const& value)
+{
+	TreePath<T, U> path;
+	if (!path_to_value(path, tree, value)) return false;
+	path_to_successor(path);
+	unlink_node(path.back());
+	for (auto i = path.size - 1; i-- > 0;) rebalance(path[i]);
+	return true;
+}
+
+} // namespace
+
+// Bulk built trees are complete: all black but an unfilled last level
+// of red nodes keeps the red-black rules
+template<typename T>
+void balance_node(Node<T, Color>& node, bool bottom)
+{
+	node.thread.red = bottom;
+}
+
+template<typename T>
+void balance_node(Node<T, Height>& node, bool)
+{
+	update_node(node);
+}
+
+template<typename T>
+void add_node(RedBlackTree<T>& tree, T&& value)
+{
+	TreePath<T, Color> path;
+	path_to_leaf(path, tree, value);
+	path.back() = make_node<T, Color>(std::forward<T>(value));
+
+	auto i = path.size - 1;
+	while (i >= 2 && is_red(path[i - 1]))
+	{
+		auto& parent = path[i - 1];
+		auto& grand = path[i - 2];
+		auto const left = &grand->left == &parent;
+		auto& uncle = left ? grand->right : grand->left;
+		if (is_red(uncle))
+		{
+			parent->thread.red = false;
+			uncle->thread.red = false;
+			grand->thread.red = true;
+			i -= 2;
+			continue;
+		}
+
+		if (left)
+		{
+			if (&parent->right == &path[i]) rotate_left(parent);
+			rotate_right(grand);
+		}
+		else
+		{
+			if (&parent->left == &path[i]) rotate_right(parent);
+			rotate_left(grand);
+		}
+		grand->thread.red = false;
+		grand->left->thread.red = true;
+		grand->right->thread.red = true;
+		break;
+	}
+	tree->thread.red = false;
+}
+
+template<typename T>
+bool erase_node(RedBlackTree<T>& tree, T const& value)
+{
+	TreePath<T, Color> path;
+	if (!path_to_value(path, tree, value)) return false;
+	path_to_successor(path);
+
+	auto const removed = unlink_node(path.back());
+	if (removed->thread.red) return true;
+	if (is_red(path.back()))
+	{
+		path.back()->thread.red = false;
+		return true;
+	}
+
+	// The link at the end of the path is short of one black node
+	for (auto i = path.size - 1; i > 0;)
+	{
+		auto const left = &path[i - 1]->left == &path[i];
+		if (is_red(left ? path[i - 1]->right : path[i - 1]->left))
+		{
+			auto& parent = path[i - 1];
+			parent->thread.red = true;
+			if (left) rotate_left(parent);
+			else rotate_right(parent);
+			parent->thread.red = false;
+			// The parent went one level down under the sibling
+			path.links[i + 1] = path.links[i];
+			path.links[i] = left ? &parent->left : &parent->right;
+			++i;
+		}
+
+		auto& parent = path[i - 1];
+		auto& sibling = left ? parent->right : parent->left;
+		if (!is_red(sibling->left) && !is_red(sibling->right))
+		{
+			sibling->thread.red = true;
+			if (parent->thread.red)
+			{
+				parent->thread.red = false;
+				break;
+			}
+			--i;
+			continue;
+		}
+
+		auto const red = parent->thread.red;
+		if (left)
+		{
+			if (!is_red(sibling->right)) rotate_right(sibling);
+			rotate_left(parent);
+		}
+		else
+		{
+			if (!is_red(sibling->left)) rotate_left(sibling);
+			rotate_right(parent);
+		}
+		parent->thread.red = red;
+		parent->left->thread.red = false;
+		parent->right->thread.red = false;
+		break;
+	}
+	return true;
+}
+
+template<typename T>
+void add_node(AvlTree<T>& tree, T&& value)
+{
+	avl_add(tree, std::forward<T>(value));
+}
+
+template<typename T>
+bool erase_node(AvlTree<T>& tree, T const& value)
+{
+	return avl_erase(tree, value);
+}
+
+} // namespace taiga
+
+#endif // _BALANCED_TREE_H_
@@ -0,0 +1,312 @@
+﻿#ifndef _BPLUS_TREE_H_
+#define _BPLUS_TREE_H_
+
+#include "tree.h"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace taiga
+{
+
+// Keys of one node take four cache lines
+constexpr size_t BPlusNodeBytes = 256;
+
+// Number of keys less than the value and greater than the value, the
+// generic loops are branch free and the int keys are compared four at
+// a time where SSE2 is there
+template<typename T>
+size_t count_less(T const* keys, size_t count, T const& value)
+{
+	size_t less = 0;
+	for (size_t i = 0; i < count; ++i) less += keys[i] < value;
+	return less;
+}
+
+template<typename T>
+size_t count_greater(T const* keys, size_t count, T const& value)
+{
+	size_t greater = 0;
+	for (size_t i = 0; i < count; ++i) greater += value < keys[i];
+	return greater;
+}
+
+#ifdef __SSE2__
+size_t count_less(int32_t const* keys, size_t count, int32_t value)
+{
+	auto const v = _mm_set1_epi32(value);
+	size_t less = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		auto const k = _mm_loadu_si128(reinterpret_cast<__m128i const*>(keys + i));
+		less += std::bitset<4>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(k, v)))).count();
+	}
+	for (; i < count; ++i) less += keys[i] < value;
+	return less;
+}
+
+size_t count_greater(int32_t const* keys, size_t count, int32_t value)
+{
+	auto const v = _mm_set1_epi32(value);
+	size_t greater = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		auto const k = _mm_loadu_si128(reinterpret_cast<__m128i const*>(keys + i));
+		greater += std::bitset<4>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, v)))).count();
+	}
+	for (; i < count; ++i) greater += value < keys[i];
+	return greater;
+}
+#endif
+
+// Ordered set of distinct values kept in the leaves, inner nodes hold
+// separators: child i takes the values from keys[i - 1] up to keys[i].
+// Leaves are linked both ways for ordered scans. T has to be default
+// constructible and copyable
+template<typename T>
+class BPlusTree
+{
+public:
+	static constexpr size_t Capacity = std::max<size_t>(4, BPlusNodeBytes / sizeof(T));
+
+	BPlusTree() = default;
+	~BPlusTree() { destroy(root_); }
+
+	BPlusTree(BPlusTree&& other) noexcept { swap(other); }
+	BPlusTree& operator=(BPlusTree&& other) noexcept { swap(other); return *this; }
+	BPlusTree(BPlusTree const&) = delete;
+	BPlusTree& operator=(BPlusTree const&) = delete;
+
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	int depth() const { return depth_; }
+
+	// False when the value is there already
+	bool add_value(T value);
+	T const* find(T const& value) const;
+
+	template<typename F>
+	void for_each(F&& func) const
+	{
+		for (auto leaf = first_; leaf; leaf = leaf->next)
+			for (size_t i = 0; i < leaf->count; ++i) func(leaf->keys[i]);
+	}
+
+	template<typename F>
+	void for_each_backward(F&& func) const
+	{
+		for (auto leaf = last_; leaf; leaf = leaf->prev)
+			for (auto i = leaf->count; i-- > 0;) func(leaf->keys[i]);
+	}
+
+private:
+	struct alignas(64) Base
+	{
+		explicit Base(bool l): leaf{l} {}
+
+		std::array<T, Capacity> keys;
+		size_t count{0};
+		bool leaf;
+	};
+
+	struct Inner: Base
+	{
+		Inner(): Base{false} {}
+
+		std::array<Base*, Capacity + 1> children{};
+	};
+
+	struct Leaf: Base
+	{
+		Leaf(): Base{true} {}
+
+		Leaf* prev{nullptr};
+		Leaf* next{nullptr};
+	};
+
+	static size_t child_of(Base const* node, T const& value)
+	{
+		return node->count - count_greater(node->keys.data(), node->count, value);
+	}
+
+	static void destroy(Base* node);
+	void swap(BPlusTree& other);
+
+	Base* root_{nullptr};
+	Leaf* first_{nullptr};
+	Leaf* last_{nullptr};
+	size_t size_{0};
+	int depth_{0};
+};
+
+template<typename T>
+void BPlusTree<T>::destroy(Base* node)
+{
+	if (!node) return;
+	if (node->leaf)
+	{
+		delete static_cast<Leaf*>(node);
+		return;
+	}
+	auto inner = static_cast<Inner*>(node);
+	for (size_t i = 0; i <= inner->count; ++i) destroy(inner->children[i]);
+	delete inner;
+}
+
+template<typename T>
+void BPlusTree<T>::swap(BPlusTree& other)
+{
+	std::swap(root_, other.root_);
+	std::swap(first_, other.first_);
+	std::swap(last_, other.last_);
+	std::swap(size_, other.size_);
+	std::swap(depth_, other.depth_);
+}
+
+template<typename T>
+T const* BPlusTree<T>::find(T const& value) const
+{
+	auto node = root_;
+	if (!node) return nullptr;
+	while (!node->leaf) node = static_cast<Inner const*>(node)->children[child_of(node, value)];
+	auto const i = count_less(node->keys.data(), node->count, value);
+	if (i < node->count && !(value < node->keys[i])) return &node->keys[i];
+	return nullptr;
+}
+
+template<typename T>
+bool BPlusTree<T>::add_value(T value)
+{
+	if (!root_)
+	{
+		root_ = first_ = last_ = new Leaf;
+		depth_ = 1;
+	}
+
+	std::array<std::pair<Inner*, size_t>, 64> path;
+	size_t levels = 0;
+	auto node = root_;
+	while (!node->leaf)
+	{
+		auto const i = child_of(node, value);
+		path[levels++] = {static_cast<Inner*>(node), i};
+		node = static_cast<Inner*>(node)->children[i];
+	}
+
+	auto leaf = static_cast<Leaf*>(node);
+	auto at = count_less(leaf->keys.data(), leaf->count, value);
+	if (at < leaf->count && !(value < leaf->keys[at])) return false;
+	++size_;
+
+	if (leaf->count < Capacity)
+	{
+		std::move_backward(leaf->keys.data() + at, leaf->keys.data() + leaf->count,
+			leaf->keys.data() + leaf->count + 1);
+		leaf->keys[at] = std::move(value);
+		++leaf->count;
+		return true;
+	}
+
+	// Split the leaf, the first key of the right half goes up
+	auto right = new Leaf;
+	auto const half = (Capacity + 1) / 2;
+	std::array<T, Capacity + 1> all;
+	std::move(leaf->keys.data(), leaf->keys.data() + at, all.data());
+	all[at] = std::move(value);
+	std::move(leaf->keys.data() + at, leaf->keys.data() + Capacity, all.data() + at + 1);
+	std::move(all.data(), all.data() + half, leaf->keys.data());
+	std::move(all.data() + half, all.data() + Capacity + 1, right->keys.data());
+	leaf->count = half;
+	right->count = Capacity + 1 - half;
+	right->prev = leaf;
+	right->next = leaf->next;
+	if (leaf->next) leaf->next->prev = right;
+	else last_ = right;
+	leaf->next = right;
+
+	T separator = right->keys[0];
+	Base* added = right;
+	while (levels > 0)
+	{
+		auto [inner, i] = path[--levels];
+		if (inner->count < Capacity)
+		{
+			std::move_backward(inner->keys.data() + i, inner->keys.data() + inner->count,
+				inner->keys.data() + inner->count + 1);
+			std::move_backward(inner->children.data() + i + 1, inner->children.data() + inner->count + 1,
+				inner->children.data() + inner->count + 2);
+			inner->keys[i] = std::move(separator);
+			inner->children[i + 1] = added;
+			++inner->count;
+			return true;
+		}
+
+		// Split the inner node, the middle key goes up
+		std::array<T, Capacity + 1> keys;
+		std::array<Base*, Capacity + 2> children;
+		std::move(inner->keys.data(), inner->keys.data() + i, keys.data());
+		keys[i] = std::move(separator);
+		std::move(inner->keys.data() + i, inner->keys.data() + Capacity, keys.data() + i + 1);
+		std::copy(inner->children.data(), inner->children.data() + i + 1, children.data());
+		children[i + 1] = added;
+		std::copy(inner->children.data() + i + 1, inner->children.data() + Capacity + 1, children.data() + i + 2);
+
+		auto sibling = new Inner;
+		auto const middle = (Capacity + 1) / 2;
+		std::move(keys.data(), keys.data() + middle, inner->keys.data());
+		std::copy(children.data(), children.data() + middle + 1, inner->children.data());
+		inner->count = middle;
+		std::move(keys.data() + middle + 1, keys.data() + Capacity + 1, sibling->keys.data());
+		std::copy(children.data() + middle + 1, children.data() + Capacity + 2, sibling->children.data());
+		sibling->count = Capacity - middle;
+		separator = std::move(keys[middle]);
+		added = sibling;
+	}
+
+	auto root = new Inner;
+	root->keys[0] = std::move(separator);
+	root->children[0] = root_;
+	root->children[1] = added;
+	root->count = 1;
+	root_ = root;
+	++depth_;
+	return true;
+}
+
+// Values live in the leaves only, so every traversal order of tree.h
+// visits them in the order of the leaves
+template<typename T, typename F>
+void forward_traverse(BPlusTree<T> const& tree, F&& func) { tree.for_each(func); }
+
+template<typename T, typename F>
+void symmetric_traverse(BPlusTree<T> const& tree, F&& func) { tree.for_each(func); }
+
+template<typename T, typename F>
+void backward_traverse(BPlusTree<T> const& tree, F&& func) { tree.for_each(func); }
+
+template<typename T, typename F>
+void level_traverse(BPlusTree<T> const& tree, F&& func) { tree.for_each(func); }
+
+template<typename T, typename F>
+void symmetric_backward_traverse(BPlusTree<T> const& tree, F&& func) { tree.for_each_backward(func); }
+
+template<typename T>
+BPlusTree<T> make_bplus_tree(std::vector<T> const& values = {})
+{
+	BPlusTree<T> tree;
+	for (auto const& v: values) tree.add_value(v);
+	return tree;
+}
+
+} // namespace taiga
+
+#endif // _BPLUS_TREE_H_
@@ -0,0 +1,124 @@
+﻿#ifndef _BULK_TREE_H_
+#define _BULK_TREE_H_
+
+#include "thread_tree.h"
+#include "tree.h"
+
+#include "../core/parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace taiga
+{
+
+// Balance data of a bulk built node, bottom tells a node on the unfilled
+// last level. Balanced variants overload it, other threads stay empty
+template<typename T, typename U>
+void balance_node(Node<T, U>&, bool) {}
+
+namespace
+{
+
+template<typename T>
+void sort_values(std::vector<T>& values)
+{
+	if (!std::is_sorted(std::begin(values), std::end(values)))
+		core::parallel_sort(std::begin(values), std::end(values));
+}
+
+// In-order ranks of the nodes of the complete tree of n nodes
+// numbered in level order from 1
+std::vector<size_t> level_order_ranks(size_t n)
+{
+	std::vector<size_t> ranks(n + 1);
+	size_t k = 1;
+	while (2 * k <= n) k *= 2;
+	for (size_t rank = 0; rank < n; ++rank)
+	{
+		ranks[k] = rank;
+		if (2 * k + 1 <= n)
+		{
+			k = 2 * k + 1;
+			while (2 * k <= n) k *= 2;
+		}
+		else
+		{
+			while (k & 1) k >>= 1;
+			k >>= 1;
+		}
+	}
+	return ranks;
+}
+
+size_t level_of(size_t k)
+{
+	size_t level = 0;
+	while (k >>= 1) ++level;
+	return level;
+}
+
+// Nodes are made in level order, so the allocator lays the top levels
+// out next to each other, and linked bottom up
+template<typename T, typename U>
+std::vector<Link<T, U>> make_level_nodes(std::vector<T>& values)
+{
+	auto const n = values.size();
+	auto const ranks = level_order_ranks(n);
+	std::vector<Link<T, U>> nodes(n + 1);
+	for (size_t k = 1; k <= n; ++k) nodes[k] = make_node<T, U>(std::move(values[ranks[k]]));
+	return nodes;
+}
+
+template<typename T, typename U>
+Link<T, U> link_level_nodes(std::vector<Link<T, U>>& nodes)
+{
+	auto const n = nodes.size() - 1;
+	auto const depth = level_of(n);
+	auto const full = (n & (n + 1)) == 0;
+	for (auto k = n; k > 0; --k)
+	{
+		if (2 * k <= n) nodes[k]->left = std::move(nodes[2 * k]);
+		if (2 * k + 1 <= n) nodes[k]->right = std::move(nodes[2 * k + 1]);
+		balance_node(*nodes[k], !full && level_of(k) == depth);
+	}
+	return std::move(nodes[1]);
+}
+
+} // namespace
+
+// Sorts the values, in parallel for large inputs, and builds a complete
+// tree in O(n) without comparisons
+template<typename T, typename U = Thread>
+Link<T, U> make_balanced_tree(std::vector<T> values)
+{
+	if (values.empty()) return {};
+	sort_values(values);
+	auto nodes = make_level_nodes<T, U>(values);
+	return link_level_nodes(nodes);
+}
+
+template<typename T>
+ThreadTree<T> make_balanced_thread_tree(std::vector<T> values)
+{
+	if (values.empty()) return {};
+	sort_values(values);
+	auto const n = values.size();
+	auto nodes = make_level_nodes<T, Threads<T>>(values);
+
+	// Threads lead to the neighbours in order where a child is missing
+	auto const ranks = level_order_ranks(n);
+	std::vector<NodePtr<T>> ordered(n);
+	for (size_t k = 1; k <= n; ++k) ordered[ranks[k]] = nodes[k].get();
+	for (size_t k = 1; k <= n; ++k)
+	{
+		auto const rank = ranks[k];
+		if (2 * k > n && rank > 0) nodes[k]->thread.left = ordered[rank - 1];
+		if (2 * k + 1 > n && rank + 1 < n) nodes[k]->thread.right = ordered[rank + 1];
+	}
+	return link_level_nodes(nodes);
+}
+
+} // namespace taiga
+
+#endif // _BULK_TREE_H_
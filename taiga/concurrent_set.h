@@ -0,0 +1,275 @@
+﻿#ifndef _CONCURRENT_SET_H_
+#define _CONCURRENT_SET_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace taiga
+{
+
+// Lock-free skip list set. A node is removed by marking its links top
+// down, the level 0 mark decides the removal, searches unlink marked
+// nodes on the way. Readers never write and never wait. Unlinked nodes
+// stay allocated until the set dies, since a reader may still stand on
+// one: a set under steady churn grows with the number of removals.
+// Scans are weakly consistent, they see every value that stays in the
+// set for the whole scan
+template<typename T>
+class ConcurrentSet
+{
+	static constexpr int MaxLevel = 32;
+
+	struct Node
+	{
+		Node(std::optional<T> v, int l): value{std::move(v)}, levels{l}, next{new std::atomic<uintptr_t>[l]}
+		{
+			for (int i = 0; i < l; ++i) next[i].store(0, std::memory_order_relaxed);
+		}
+
+		std::optional<T> value;
+		int levels;
+		std::unique_ptr<std::atomic<uintptr_t>[]> next;
+		Node* allocated{nullptr};
+	};
+
+	static Node* pointer(uintptr_t link) { return reinterpret_cast<Node*>(link & ~uintptr_t{1}); }
+	static bool marked(uintptr_t link) { return (link & 1) != 0; }
+	static uintptr_t link_to(Node* node, bool mark = false) { return reinterpret_cast<uintptr_t>(node) | mark; }
+
+public:
+	ConcurrentSet(): head_{new Node{std::nullopt, MaxLevel}} {}
+
+	~ConcurrentSet()
+	{
+		for (auto node = allocated_.load(std::memory_order_acquire); node;)
+		{
+			auto const next = node->allocated;
+			delete node;
+			node = next;
+		}
+		delete head_;
+	}
+
+	ConcurrentSet(ConcurrentSet const&) = delete;
+	ConcurrentSet& operator=(ConcurrentSet const&) = delete;
+
+	// Values in the set, exact when no writer runs
+	size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+	bool contains(T const& value) const
+	{
+		auto const node = lower_bound(value);
+		return node && !(value < *node->value);
+	}
+
+	// False when the value is there already
+	bool add_value(T value);
+	// False when the value is not there or another thread erased it first
+	bool erase_value(T const& value);
+
+	// func(value) for the values in [low, high) in order
+	template<typename F>
+	void for_each_range(T const& low, T const& high, F&& func) const
+	{
+		for (auto node = lower_bound(low); node && *node->value < high; node = next_live(node))
+			func(*node->value);
+	}
+
+	template<typename F>
+	void for_each(F&& func) const
+	{
+		for (auto node = next_live(head_); node; node = next_live(node)) func(*node->value);
+	}
+
+private:
+	static bool less(Node const* node, T const& value) { return node && *node->value < value; }
+
+	// Fills the neighbours of the value on every level, unlinking the
+	// marked nodes met on the way
+	bool find(T const& value, Node** preds, Node** succs);
+	Node const* lower_bound(T const& value) const;
+	Node const* next_live(Node const* node) const;
+	int random_level();
+
+	Node* head_;
+	// Highest level in use, searches start there
+	std::atomic<int> top_{1};
+	std::atomic<Node*> allocated_{nullptr};
+	std::atomic<size_t> size_{0};
+};
+
+template<typename T>
+int ConcurrentSet<T>::random_level()
+{
+	thread_local uint64_t state = 0x9e3779b97f4a7c15ull ^ reinterpret_cast<uintptr_t>(&state);
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	int level = 1;
+	for (auto bits = state; (bits & 1) && level < MaxLevel; bits >>= 1) ++level;
+	return level;
+}
+
+template<typename T>
+bool ConcurrentSet<T>::find(T const& value, Node** preds, Node** succs)
+{
+retry:
+	auto pred = head_;
+	auto const top = top_.load(std::memory_order_acquire);
+	for (auto level = MaxLevel - 1; level >= top; --level)
+	{
+		preds[level] = head_;
+		succs[level] = nullptr;
+	}
+	for (auto level = top - 1; level >= 0; --level)
+	{
+		auto curr = pointer(pred->next[level].load(std::memory_order_acquire));
+		while (curr)
+		{
+			auto succ = curr->next[level].load(std::memory_order_acquire);
+			while (marked(succ))
+			{
+				auto expected = link_to(curr);
+				if (!pred->next[level].compare_exchange_strong(expected, link_to(pointer(succ)),
+					std::memory_order_acq_rel, std::memory_order_acquire))
+					goto retry;
+				curr = pointer(succ);
+				if (!curr) break;
+				succ = curr->next[level].load(std::memory_order_acquire);
+			}
+			if (!less(curr, value)) break;
+			pred = curr;
+			curr = pointer(succ);
+		}
+		preds[level] = pred;
+		succs[level] = curr;
+	}
+	return succs[0] && !(value < *succs[0]->value);
+}
+
+template<typename T>
+bool ConcurrentSet<T>::add_value(T value)
+{
+	Node* preds[MaxLevel];
+	Node* succs[MaxLevel];
+	auto const levels = random_level();
+	for (auto top = top_.load(std::memory_order_relaxed); top < levels;)
+		top_.compare_exchange_weak(top, levels, std::memory_order_acq_rel, std::memory_order_relaxed);
+	auto fresh = std::make_unique<Node>(std::move(value), levels);
+	while (true)
+	{
+		if (find(*fresh->value, preds, succs)) return false;
+		for (int i = 0; i < levels; ++i) fresh->next[i].store(link_to(succs[i]), std::memory_order_relaxed);
+
+		auto expected = link_to(succs[0]);
+		if (preds[0]->next[0].compare_exchange_strong(expected, link_to(fresh.get()),
+			std::memory_order_acq_rel, std::memory_order_acquire))
+			break;
+	}
+
+	auto node = fresh.release();
+	node->allocated = allocated_.load(std::memory_order_relaxed);
+	while (!allocated_.compare_exchange_weak(node->allocated, node, std::memory_order_release, std::memory_order_relaxed)) {}
+	size_.fetch_add(1, std::memory_order_relaxed);
+
+	for (int level = 1; level < levels; ++level)
+	{
+		while (true)
+		{
+			// Stop linking once an eraser started marking the node
+			auto own = node->next[level].load(std::memory_order_acquire);
+			if (marked(own)) return true;
+			if (pointer(own) != succs[level] && !node->next[level].compare_exchange_strong(own,
+				link_to(succs[level]), std::memory_order_acq_rel, std::memory_order_acquire))
+				return true;
+
+			auto expected = link_to(succs[level]);
+			if (preds[level]->next[level].compare_exchange_strong(expected, link_to(node),
+				std::memory_order_acq_rel, std::memory_order_acquire))
+				break;
+			find(*node->value, preds, succs);
+			if (succs[0] != node) return true;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+bool ConcurrentSet<T>::erase_value(T const& value)
+{
+	Node* preds[MaxLevel];
+	Node* succs[MaxLevel];
+	if (!find(value, preds, succs)) return false;
+	auto const node = succs[0];
+
+	for (auto level = node->levels - 1; level > 0; --level)
+	{
+		auto succ = node->next[level].load(std::memory_order_acquire);
+		while (!marked(succ) && !node->next[level].compare_exchange_weak(succ, succ | 1,
+			std::memory_order_acq_rel, std::memory_order_acquire)) {}
+	}
+
+	auto succ = node->next[0].load(std::memory_order_acquire);
+	while (true)
+	{
+		if (marked(succ)) return false;
+		if (node->next[0].compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			size_.fetch_sub(1, std::memory_order_relaxed);
+			find(value, preds, succs);
+			return true;
+		}
+	}
+}
+
+template<typename T>
+typename ConcurrentSet<T>::Node const* ConcurrentSet<T>::lower_bound(T const& value) const
+{
+	Node const* pred = head_;
+	Node const* curr = nullptr;
+	for (auto level = top_.load(std::memory_order_acquire) - 1; level >= 0; --level)
+	{
+		curr = pointer(pred->next[level].load(std::memory_order_acquire));
+		while (curr)
+		{
+			auto const succ = curr->next[level].load(std::memory_order_acquire);
+			if (marked(succ))
+			{
+				curr = pointer(succ);
+				continue;
+			}
+			if (!less(curr, value)) break;
+			pred = curr;
+			curr = pointer(succ);
+		}
+	}
+	return curr;
+}
+
+template<typename T>
+typename ConcurrentSet<T>::Node const* ConcurrentSet<T>::next_live(Node const* node) const
+{
+	auto curr = pointer(node->next[0].load(std::memory_order_acquire));
+	while (curr)
+	{
+		auto const succ = curr->next[0].load(std::memory_order_acquire);
+		if (!marked(succ)) return curr;
+		curr = pointer(succ);
+	}
+	return nullptr;
+}
+
+// In order scan as with the threads of a ThreadTree
+template<typename T, typename F>
+void symmetric_forward_traverse(ConcurrentSet<T> const& set, F&& func)
+{
+	set.for_each(std::forward<F>(func));
+}
+
+} // namespace taiga
+
+#endif // _CONCURRENT_SET_H_
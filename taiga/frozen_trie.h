@@ -0,0 +1,442 @@
+﻿#ifndef _FROZEN_TRIE_H_
+#define _FROZEN_TRIE_H_
+
+#include "prefix_tree.h"
+
+#include "../core/mapped_file.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace taiga
+{
+
+// Bits with a directory of the ones before every 512 bits, so rank reads
+// at most eight words, and the block of every 512th zero, so select0
+// searches the directory between two samples
+class RankBitVector
+{
+public:
+	static constexpr size_t BlockWords = 8;
+	static constexpr size_t SampleZeros = 512;
+
+	RankBitVector() = default;
+	RankBitVector(uint64_t const* words, uint64_t const* ranks, uint64_t const* samples, size_t bits):
+		words_{words}, ranks_{ranks}, samples_{samples}, bits_{bits} {}
+
+	static size_t words(size_t bits) { return (bits + 63) / 64; }
+	static size_t blocks(size_t bits) { return (words(bits) + BlockWords - 1) / BlockWords + 1; }
+	static size_t samples(size_t bits) { return bits / SampleZeros + 2; }
+
+	size_t size() const { return bits_; }
+	bool operator[](size_t i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+
+	// Ones before the position
+	size_t rank1(size_t i) const
+	{
+		auto const word = i / 64;
+		auto rank = ranks_[word / BlockWords];
+		for (auto w = word / BlockWords * BlockWords; w < word; ++w) rank += std::bitset<64>(words_[w]).count();
+		if (i % 64) rank += std::bitset<64>(words_[word] & ((uint64_t{1} << (i % 64)) - 1)).count();
+		return rank;
+	}
+
+	// Position of the zero of the given rank counting from 0
+	size_t select0(size_t rank) const
+	{
+		auto const zeros = [this](size_t block) { return block * BlockWords * 64 - ranks_[block]; };
+		size_t low = samples_[rank / SampleZeros];
+		auto high = samples_[rank / SampleZeros + 1] + 1;
+		while (high - low > 1)
+		{
+			auto const middle = (low + high) / 2;
+			if (zeros(middle) <= rank) low = middle;
+			else high = middle;
+		}
+
+		rank -= zeros(low);
+		auto w = low * BlockWords;
+		for (size_t z; rank >= (z = 64 - std::bitset<64>(words_[w]).count()); ++w) rank -= z;
+		auto word = ~words_[w];
+		for (; rank > 0; --rank) word &= word - 1;
+		return w * 64 + lowest_bit(word);
+	}
+
+	// First zero at the position or after it
+	size_t next_zero(size_t i) const
+	{
+		auto w = i / 64;
+		auto word = ~words_[w] & (~uint64_t{0} << (i % 64));
+		while (!word) word = ~words_[++w];
+		return w * 64 + lowest_bit(word);
+	}
+
+private:
+	static size_t lowest_bit(uint64_t word)
+	{
+#ifdef __GNUC__
+		return __builtin_ctzll(word);
+#else
+		size_t bit = 0;
+		while (!(word & 1)) word >>= 1, ++bit;
+		return bit;
+#endif
+	}
+
+	uint64_t const* words_{nullptr};
+	uint64_t const* ranks_{nullptr};
+	uint64_t const* samples_{nullptr};
+	size_t bits_{0};
+};
+
+// Frozen trie in native byte order: the header is followed by the LOUDS
+// bits of the shape with their rank directory and select samples, the
+// bits of the nodes with a value with their rank directory, the edge byte
+// into every node, the offsets of the compressed keys of the nodes, the
+// key bytes and the values. Nodes are numbered in level order, children
+// in byte order, and every section starts at a multiple of 8 bytes
+struct TrieFileHeader
+{
+	char magic[4]{'T', 'G', 'T', 'R'};
+	uint32_t version{1};
+	uint32_t value_size{0};
+	uint32_t reserved{0};
+	uint64_t nodes{0};
+	uint64_t values{0};
+	uint64_t key_bytes{0};
+};
+
+constexpr uint32_t TrieFileVersion = 1;
+
+namespace
+{
+
+constexpr size_t align_words(size_t size) { return (size + 7) & ~size_t{7}; }
+
+// A node takes a one in the bits of its parent and ends its own with a
+// zero, so n nodes take 2n - 1 bits
+size_t louds_bits(uint64_t nodes) { return nodes ? 2 * nodes - 1 : 0; }
+
+struct TrieFileLayout
+{
+	size_t louds;
+	size_t louds_ranks;
+	size_t louds_samples;
+	size_t value_bits;
+	size_t value_ranks;
+	size_t labels;
+	size_t key_offsets;
+	size_t keys;
+	size_t values;
+	size_t size;
+
+	explicit TrieFileLayout(TrieFileHeader const& header)
+	{
+		auto const louds_size = louds_bits(header.nodes);
+		louds = align_words(sizeof(TrieFileHeader));
+		louds_ranks = louds + RankBitVector::words(louds_size) * sizeof(uint64_t);
+		louds_samples = louds_ranks + RankBitVector::blocks(louds_size) * sizeof(uint64_t);
+		value_bits = louds_samples + RankBitVector::samples(louds_size) * sizeof(uint64_t);
+		value_ranks = value_bits + RankBitVector::words(header.nodes) * sizeof(uint64_t);
+		labels = value_ranks + RankBitVector::blocks(header.nodes) * sizeof(uint64_t);
+		key_offsets = align_words(labels + header.nodes);
+		keys = key_offsets + (header.nodes + 1) * sizeof(uint64_t);
+		values = align_words(keys + header.key_bytes);
+		size = align_words(values + header.values * header.value_size);
+	}
+};
+
+void set_bit(uint64_t* words, size_t i) { words[i / 64] |= uint64_t{1} << (i % 64); }
+
+void fill_ranks(uint64_t const* words, uint64_t* ranks, size_t bits)
+{
+	uint64_t rank = 0;
+	auto const count = RankBitVector::words(bits);
+	for (size_t w = 0; w < count; ++w)
+	{
+		if (w % RankBitVector::BlockWords == 0) ranks[w / RankBitVector::BlockWords] = rank;
+		rank += std::bitset<64>(words[w]).count();
+	}
+	ranks[RankBitVector::blocks(bits) - 1] = rank;
+}
+
+// Block of every sampled zero, the last sample closes the directory
+void fill_samples(uint64_t const* words, uint64_t* samples, size_t bits)
+{
+	size_t zeros = 0;
+	size_t sample = 0;
+	auto const count = RankBitVector::words(bits);
+	for (size_t w = 0; w < count; ++w)
+	{
+		auto const in_word = 64 - std::bitset<64>(words[w]).count();
+		while (sample * RankBitVector::SampleZeros < zeros + in_word)
+			samples[sample++] = w / RankBitVector::BlockWords;
+		zeros += in_word;
+	}
+	while (sample < RankBitVector::samples(bits)) samples[sample++] = RankBitVector::blocks(bits) - 1;
+}
+
+template<typename T>
+void check_header(TrieFileHeader const& header, size_t size)
+{
+	if (size < sizeof(TrieFileHeader)) throw std::runtime_error{"truncated trie file"};
+	if (std::memcmp(header.magic, TrieFileHeader{}.magic, sizeof(header.magic)) != 0)
+		throw std::runtime_error{"not a trie file"};
+	if (header.version != TrieFileVersion) throw std::runtime_error{"unsupported trie file version"};
+	if (header.value_size != sizeof(T)) throw std::runtime_error{"trie file types mismatch"};
+
+	// Counts that keep every section of the layout, and their sum, far
+	// from overflowing size_t
+	constexpr auto limit = std::numeric_limits<size_t>::max() / 8;
+	if (header.nodes >= limit / 32 || header.values > header.nodes || header.values >= limit / sizeof(T)
+		|| header.key_bytes >= limit)
+		throw std::runtime_error{"trie file too large"};
+	if (size < TrieFileLayout{header}.size) throw std::runtime_error{"truncated trie file"};
+}
+
+// The bits hold the given number of ones and no bit past their size, the
+// directory and the samples are the ones the bits give
+void check_bits(uint64_t const* words, uint64_t const* ranks, uint64_t const* samples, size_t bits, size_t ones)
+{
+	auto const count = RankBitVector::words(bits);
+	size_t found = 0;
+	for (size_t w = 0; w < count; ++w) found += std::bitset<64>(words[w]).count();
+	if (found != ones || (bits % 64 && words[count - 1] >> (bits % 64)))
+		throw std::runtime_error{"corrupt trie file bits"};
+
+	std::vector<uint64_t> expected(RankBitVector::blocks(bits));
+	fill_ranks(words, expected.data(), bits);
+	if (!std::equal(std::begin(expected), std::end(expected), ranks))
+		throw std::runtime_error{"corrupt trie file ranks"};
+	if (!samples) return;
+	expected.assign(RankBitVector::samples(bits), 0);
+	fill_samples(words, expected.data(), bits);
+	if (!std::equal(std::begin(expected), std::end(expected), samples))
+		throw std::runtime_error{"corrupt trie file samples"};
+}
+
+} // namespace
+
+// Read only trie frozen from a prefix tree into the layout of its file,
+// so the same arrays serve a trie built in memory and a mapped one
+template<typename T>
+class FrozenTrie
+{
+public:
+	static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be stored");
+	static_assert(alignof(T) <= sizeof(uint64_t), "sections are only aligned to 8 bytes");
+
+	explicit FrozenTrie(PrefixTree<T> const& tree);
+	explicit FrozenTrie(std::string const& path): file_{std::in_place, path}
+	{
+		attach(file_->data(), file_->size());
+		check();
+	}
+
+	FrozenTrie(FrozenTrie&&) = default;
+	FrozenTrie& operator=(FrozenTrie&&) = default;
+	FrozenTrie(FrozenTrie const&) = delete;
+	FrozenTrie& operator=(FrozenTrie const&) = delete;
+
+	// Number of values
+	size_t size() const { return header_.values; }
+	size_t nodes() const { return header_.nodes; }
+	// Bytes of the file, and of the memory a trie built in place takes
+	size_t image_size() const { return TrieFileLayout{header_}.size; }
+
+	T const* find_value(std::string_view key) const;
+
+	void write(std::ostream& out) const { out.write(data_, image_size()); }
+
+private:
+	void attach(char const* data, size_t size);
+	void check() const;
+
+	std::string_view node_key(size_t node) const
+	{
+		return {keys_ + key_offsets_[node], static_cast<size_t>(key_offsets_[node + 1] - key_offsets_[node])};
+	}
+
+	std::vector<uint64_t> image_;
+	std::optional<core::MappedFile> file_;
+	char const* data_{nullptr};
+	TrieFileHeader header_;
+	RankBitVector louds_;
+	RankBitVector value_bits_;
+	uint8_t const* labels_{nullptr};
+	uint64_t const* key_offsets_{nullptr};
+	char const* keys_{nullptr};
+	T const* values_{nullptr};
+};
+
+template<typename T>
+FrozenTrie<T>::FrozenTrie(PrefixTree<T> const& tree)
+{
+	std::vector<PrefixNode<T> const*> nodes;
+	std::vector<uint8_t> labels;
+	if (tree)
+	{
+		nodes.push_back(tree.get());
+		labels.push_back(0);
+	}
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		nodes[i]->children.for_each([&nodes, &labels](char edge, PrefixLink<T> const& child)
+		{
+			nodes.push_back(child.get());
+			labels.push_back(static_cast<uint8_t>(edge));
+		});
+	}
+
+	header_.value_size = sizeof(T);
+	header_.nodes = nodes.size();
+	for (auto node: nodes)
+	{
+		header_.values += node->value.has_value();
+		header_.key_bytes += node->key.size();
+	}
+	TrieFileLayout const layout{header_};
+	image_.assign(layout.size / sizeof(uint64_t), 0);
+	auto const data = reinterpret_cast<char*>(image_.data());
+	std::memcpy(data, &header_, sizeof(header_));
+
+	auto const louds = reinterpret_cast<uint64_t*>(data + layout.louds);
+	auto const value_bits = reinterpret_cast<uint64_t*>(data + layout.value_bits);
+	auto const key_offsets = reinterpret_cast<uint64_t*>(data + layout.key_offsets);
+	auto const values = reinterpret_cast<T*>(data + layout.values);
+	if (!labels.empty()) std::memcpy(data + layout.labels, labels.data(), labels.size());
+
+	size_t bit = 0;
+	uint64_t offset = 0;
+	size_t value = 0;
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		auto const& node = *nodes[i];
+		for (auto d = node.children.size(); d > 0; --d) set_bit(louds, bit++);
+		++bit;
+
+		key_offsets[i] = offset;
+		std::memcpy(data + layout.keys + offset, node.key.data(), node.key.size());
+		offset += node.key.size();
+		if (node.value)
+		{
+			set_bit(value_bits, i);
+			std::memcpy(values + value++, &*node.value, sizeof(T));
+		}
+	}
+	key_offsets[nodes.size()] = offset;
+
+	fill_ranks(louds, reinterpret_cast<uint64_t*>(data + layout.louds_ranks), louds_bits(header_.nodes));
+	fill_samples(louds, reinterpret_cast<uint64_t*>(data + layout.louds_samples), louds_bits(header_.nodes));
+	fill_ranks(value_bits, reinterpret_cast<uint64_t*>(data + layout.value_ranks), header_.nodes);
+	attach(data, layout.size);
+}
+
+template<typename T>
+void FrozenTrie<T>::attach(char const* data, size_t size)
+{
+	std::memcpy(&header_, data, std::min(size, sizeof(header_)));
+	check_header<T>(header_, size);
+
+	TrieFileLayout const layout{header_};
+	data_ = data;
+	louds_ = {reinterpret_cast<uint64_t const*>(data + layout.louds),
+		reinterpret_cast<uint64_t const*>(data + layout.louds_ranks),
+		reinterpret_cast<uint64_t const*>(data + layout.louds_samples), louds_bits(header_.nodes)};
+	value_bits_ = {reinterpret_cast<uint64_t const*>(data + layout.value_bits),
+		reinterpret_cast<uint64_t const*>(data + layout.value_ranks), nullptr, header_.nodes};
+	labels_ = reinterpret_cast<uint8_t const*>(data + layout.labels);
+	key_offsets_ = reinterpret_cast<uint64_t const*>(data + layout.key_offsets);
+	keys_ = data + layout.keys;
+	values_ = reinterpret_cast<T const*>(data + layout.values);
+}
+
+// Everything find_value reads stays in the file: key offsets grow up to
+// the key bytes, the shape has a one for every node but the root and
+// ends with a zero, a value bit is set for every value
+template<typename T>
+void FrozenTrie<T>::check() const
+{
+	auto const nodes = header_.nodes;
+	if (key_offsets_[0] != 0 || key_offsets_[nodes] != header_.key_bytes)
+		throw std::runtime_error{"corrupt trie file keys"};
+	for (size_t i = 0; i < nodes; ++i)
+		if (key_offsets_[i + 1] < key_offsets_[i]) throw std::runtime_error{"corrupt trie file keys"};
+
+	TrieFileLayout const layout{header_};
+	auto const words = [this, &layout](size_t offset) { return reinterpret_cast<uint64_t const*>(data_ + offset); };
+	auto const bits = louds_bits(nodes);
+	check_bits(words(layout.louds), words(layout.louds_ranks), words(layout.louds_samples), bits, nodes ? nodes - 1 : 0);
+	if (nodes && louds_[bits - 1]) throw std::runtime_error{"corrupt trie file bits"};
+	check_bits(words(layout.value_bits), words(layout.value_ranks), nullptr, nodes, header_.values);
+}
+
+// Children of node i are the ones of its bits: they follow the zero that
+// closes node i - 1 and take the ids after the ones before them
+template<typename T>
+T const* FrozenTrie<T>::find_value(std::string_view key) const
+{
+	if (header_.nodes == 0) return nullptr;
+	size_t node = 0;
+	while (true)
+	{
+		auto const compressed = node_key(node);
+		if (key.substr(0, compressed.size()) != compressed) return nullptr;
+		key.remove_prefix(compressed.size());
+		if (key.empty())
+			return value_bits_[node] ? &values_[value_bits_.rank1(node)] : nullptr;
+
+		auto const begin = node == 0 ? 0 : louds_.select0(node - 1) + 1;
+		auto const end = louds_.next_zero(begin);
+		auto const first = louds_.rank1(begin) + 1;
+		auto const last = first + (end - begin);
+		auto const edge = static_cast<uint8_t>(key[0]);
+		auto const child = std::lower_bound(labels_ + first, labels_ + last, edge);
+		if (child == labels_ + last || *child != edge) return nullptr;
+		node = static_cast<size_t>(child - labels_);
+		key.remove_prefix(1);
+	}
+}
+
+template<typename T>
+FrozenTrie<T> make_frozen_trie(PrefixTree<T> const& tree)
+{
+	return FrozenTrie<T>{tree};
+}
+
+template<typename T>
+T const* find_value(FrozenTrie<T> const& trie, std::string_view key)
+{
+	return trie.find_value(key);
+}
+
+template<typename T>
+T find(FrozenTrie<T> const& trie, std::string_view key)
+{
+	if (auto const value = trie.find_value(key)) return *value;
+	throw std::runtime_error{"not found"};
+}
+
+template<typename T>
+void save_frozen_trie(std::string const& path, FrozenTrie<T> const& trie)
+{
+	std::ofstream out{path, std::ios::binary};
+	if (!out) throw std::runtime_error{"cannot create " + path};
+	trie.write(out);
+	if (!out) throw std::runtime_error{"cannot write " + path};
+}
+
+} // namespace taiga
+
+#endif // _FROZEN_TRIE_H_
@@ -0,0 +1,169 @@
+﻿#ifndef _ORDER_STATISTICS_H_
+#define _ORDER_STATISTICS_H_
+
+#include "balanced_tree.h"
+
+#include <cstddef>
+#include <utility>
+
+namespace taiga
+{
+
+// Monoid aggregated over the values in order: identity, the aggregate of
+// one value and an associative combine, commutativity is not needed
+template<typename T>
+struct SumMonoid
+{
+	using type = T;
+
+	static T identity() { return T{}; }
+	static T of(T const& value) { return value; }
+	static T combine(T const& lhs, T const& rhs) { return lhs + rhs; }
+};
+
+struct NoMonoid
+{
+	struct type {};
+
+	template<typename T>
+	static type of(T const&) { return {}; }
+	static type identity() { return {}; }
+	static type combine(type, type) { return {}; }
+};
+
+// AVL balance data with the size and the aggregate of the subtree
+template<typename M>
+struct Statistics
+{
+	int height{1};
+	size_t size{1};
+	typename M::type aggregate{M::identity()};
+};
+
+template<typename T, typename M = NoMonoid>
+using StatisticsTree = Link<T, Statistics<M>>;
+
+template<typename T, typename M>
+size_t subtree_size(StatisticsTree<T, M> const& link) { return link ? link->thread.size : 0; }
+
+template<typename T, typename M>
+typename M::type subtree_aggregate(StatisticsTree<T, M> const& link)
+{
+	return link ? link->thread.aggregate : M::identity();
+}
+
+template<typename T, typename M>
+void update_node(Node<T, Statistics<M>>& node)
+{
+	node.thread.height = 1 + std::max(height(node.left), height(node.right));
+	node.thread.size = 1 + subtree_size(node.left) + subtree_size(node.right);
+	node.thread.aggregate = M::combine(
+		M::combine(subtree_aggregate(node.left), M::of(node.value)),
+		subtree_aggregate(node.right));
+}
+
+template<typename T, typename M>
+void balance_node(Node<T, Statistics<M>>& node, bool)
+{
+	update_node(node);
+}
+
+template<typename T, typename M>
+void add_node(StatisticsTree<T, M>& tree, T&& value)
+{
+	avl_add(tree, std::forward<T>(value));
+}
+
+template<typename T, typename M>
+bool erase_node(StatisticsTree<T, M>& tree, T const& value)
+{
+	return avl_erase(tree, value);
+}
+
+// Value of the given rank counting from 0, nullptr past the end
+template<typename T, typename M>
+T const* select(StatisticsTree<T, M> const& tree, size_t rank)
+{
+	auto node = tree.get();
+	while (node)
+	{
+		auto const left = subtree_size(node->left);
+		if (rank < left) node = node->left.get();
+		else if (rank == left) return &node->value;
+		else
+		{
+			rank -= left + 1;
+			node = node->right.get();
+		}
+	}
+	return nullptr;
+}
+
+// Number of values less than the given one
+template<typename T, typename M>
+size_t rank(StatisticsTree<T, M> const& tree, T const& value)
+{
+	size_t less = 0;
+	auto node = tree.get();
+	while (node)
+	{
+		if (node->value < value)
+		{
+			less += subtree_size(node->left) + 1;
+			node = node->right.get();
+		}
+		else node = node->left.get();
+	}
+	return less;
+}
+
+// Values in [low, high)
+template<typename T, typename M>
+size_t count_range(StatisticsTree<T, M> const& tree, T const& low, T const& high)
+{
+	if (!(low < high)) return 0;
+	return rank(tree, high) - rank(tree, low);
+}
+
+// Aggregate of the values in [low, high): below the node where the
+// bounds part, the left bound walk collects what lies right of it and
+// the right bound walk what lies left of it
+template<typename T, typename M>
+typename M::type aggregate_range(StatisticsTree<T, M> const& tree, T const& low, T const& high)
+{
+	auto node = tree.get();
+	while (node)
+	{
+		if (node->value < low) node = node->right.get();
+		else if (!(node->value < high)) node = node->left.get();
+		else break;
+	}
+	if (!node) return M::identity();
+
+	auto suffix = M::identity();
+	for (auto n = node->left.get(); n;)
+	{
+		if (n->value < low) n = n->right.get();
+		else
+		{
+			suffix = M::combine(M::combine(M::of(n->value), subtree_aggregate(n->right)), suffix);
+			n = n->left.get();
+		}
+	}
+
+	auto prefix = M::identity();
+	for (auto n = node->right.get(); n;)
+	{
+		if (n->value < high)
+		{
+			prefix = M::combine(prefix, M::combine(subtree_aggregate(n->left), M::of(n->value)));
+			n = n->right.get();
+		}
+		else n = n->left.get();
+	}
+	return M::combine(M::combine(suffix, M::of(node->value)), prefix);
+}
+
+} // namespace taiga
+
+#endif // _ORDER_STATISTICS_H_
@@ -1,13 +1,21 @@
 ﻿#ifndef _PREFIX_TREE_H_
 #define _PREFIX_TREE_H_
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace taiga
 {
 
@@ -19,6 +27,287 @@ using PrefixLink = std::unique_ptr<PrefixNode<T>>;
 template<typename T>
 using PrefixTree = PrefixLink<T>;
 
+// Children of a prefix node by their first byte, held in the smallest
+// of the adaptive radix tree layouts that fits them: 4 or 16 sorted keys
+// searched directly, 48 slots behind a byte index or 256 direct slots.
+// A leaf allocates nothing. Iteration goes in byte order
+template<typename T>
+class PrefixChildren
+{
+public:
+	PrefixChildren() = default;
+	~PrefixChildren() { destroy(); }
+
+	PrefixChildren(PrefixChildren&& other) noexcept: node_{other.node_} { other.node_ = nullptr; }
+	PrefixChildren& operator=(PrefixChildren&& other) noexcept
+	{
+		std::swap(node_, other.node_);
+		return *this;
+	}
+	PrefixChildren(PrefixChildren const&) = delete;
+	PrefixChildren& operator=(PrefixChildren const&) = delete;
+
+	size_t size() const { return node_ ? node_->count : 0; }
+	bool empty() const { return size() == 0; }
+	// Bytes of the layout holding the children
+	size_t heap_size() const;
+
+	PrefixLink<T>* find(char c);
+	PrefixLink<T> const* find(char c) const { return const_cast<PrefixChildren*>(this)->find(c); }
+
+	// The byte must not be there yet
+	void insert(char c, PrefixLink<T>&& child);
+
+	// func(byte, link) in byte order
+	template<typename F>
+	void for_each(F&& func) const;
+
+private:
+	enum class Kind: uint8_t { Node4, Node16, Node48, Node256 };
+
+	struct Base
+	{
+		explicit Base(Kind k): kind{k} {}
+
+		Kind kind;
+		uint16_t count{0};
+	};
+
+	template<size_t N, Kind K>
+	struct Sorted: Base
+	{
+		Sorted(): Base{K} {}
+
+		alignas(16) std::array<uint8_t, N> keys{};
+		std::array<PrefixLink<T>, N> children;
+	};
+
+	using Node4 = Sorted<4, Kind::Node4>;
+	using Node16 = Sorted<16, Kind::Node16>;
+
+	struct Node48: Base
+	{
+		Node48(): Base{Kind::Node48} {}
+
+		// Slot of the byte plus one, 0 for none
+		std::array<uint8_t, 256> index{};
+		std::array<PrefixLink<T>, 48> children;
+	};
+
+	struct Node256: Base
+	{
+		Node256(): Base{Kind::Node256} {}
+
+		std::array<PrefixLink<T>, 256> children;
+	};
+
+	template<typename S>
+	static PrefixLink<T>* find_sorted(S& node, uint8_t key)
+	{
+		for (size_t i = 0; i < node.count; ++i)
+			if (node.keys[i] == key) return &node.children[i];
+		return nullptr;
+	}
+
+	static PrefixLink<T>* find_sorted(Node16& node, uint8_t key)
+	{
+#ifdef __SSE2__
+		auto const keys = _mm_load_si128(reinterpret_cast<__m128i const*>(node.keys.data()));
+		auto const mask = _mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(key))))
+			& ((1 << node.count) - 1);
+		return mask ? &node.children[__builtin_ctz(mask)] : nullptr;
+#else
+		for (size_t i = 0; i < node.count; ++i)
+			if (node.keys[i] == key) return &node.children[i];
+		return nullptr;
+#endif
+	}
+
+	template<typename S>
+	static void insert_sorted(S& node, uint8_t key, PrefixLink<T>&& child)
+	{
+		size_t at = 0;
+		while (at < node.count && node.keys[at] < key) ++at;
+		std::move_backward(node.keys.data() + at, node.keys.data() + node.count, node.keys.data() + node.count + 1);
+		std::move_backward(node.children.data() + at, node.children.data() + node.count,
+			node.children.data() + node.count + 1);
+		node.keys[at] = key;
+		node.children[at] = std::move(child);
+		++node.count;
+	}
+
+	void grow();
+	void destroy();
+
+	Base* node_{nullptr};
+};
+
+template<typename T>
+size_t PrefixChildren<T>::heap_size() const
+{
+	if (!node_) return 0;
+	switch (node_->kind)
+	{
+	case Kind::Node4: return sizeof(Node4);
+	case Kind::Node16: return sizeof(Node16);
+	case Kind::Node48: return sizeof(Node48);
+	case Kind::Node256: return sizeof(Node256);
+	}
+	return 0;
+}
+
+template<typename T>
+PrefixLink<T>* PrefixChildren<T>::find(char c)
+{
+	if (!node_) return nullptr;
+	auto const key = static_cast<uint8_t>(c);
+	switch (node_->kind)
+	{
+	case Kind::Node4: return find_sorted(*static_cast<Node4*>(node_), key);
+	case Kind::Node16: return find_sorted(*static_cast<Node16*>(node_), key);
+	case Kind::Node48:
+	{
+		auto node = static_cast<Node48*>(node_);
+		return node->index[key] ? &node->children[node->index[key] - 1] : nullptr;
+	}
+	case Kind::Node256:
+	{
+		auto& child = static_cast<Node256*>(node_)->children[key];
+		return child ? &child : nullptr;
+	}
+	}
+	return nullptr;
+}
+
+template<typename T>
+void PrefixChildren<T>::insert(char c, PrefixLink<T>&& child)
+{
+	if (!node_) node_ = new Node4;
+	auto const key = static_cast<uint8_t>(c);
+	switch (node_->kind)
+	{
+	case Kind::Node4:
+		if (node_->count < 4) return insert_sorted(*static_cast<Node4*>(node_), key, std::move(child));
+		break;
+	case Kind::Node16:
+		if (node_->count < 16) return insert_sorted(*static_cast<Node16*>(node_), key, std::move(child));
+		break;
+	case Kind::Node48:
+		if (node_->count < 48)
+		{
+			auto node = static_cast<Node48*>(node_);
+			node->children[node->count] = std::move(child);
+			node->index[key] = static_cast<uint8_t>(++node->count);
+			return;
+		}
+		break;
+	case Kind::Node256:
+		static_cast<Node256*>(node_)->children[key] = std::move(child);
+		++node_->count;
+		return;
+	}
+	grow();
+	insert(c, std::move(child));
+}
+
+// Moves the children to the next larger layout
+template<typename T>
+void PrefixChildren<T>::grow()
+{
+	Base* grown = nullptr;
+	switch (node_->kind)
+	{
+	case Kind::Node4:
+	{
+		auto from = static_cast<Node4*>(node_);
+		auto to = new Node16;
+		std::copy(from->keys.begin(), from->keys.end(), to->keys.begin());
+		std::move(from->children.begin(), from->children.end(), to->children.begin());
+		grown = to;
+		break;
+	}
+	case Kind::Node16:
+	{
+		auto from = static_cast<Node16*>(node_);
+		auto to = new Node48;
+		for (size_t i = 0; i < from->count; ++i)
+		{
+			to->children[i] = std::move(from->children[i]);
+			to->index[from->keys[i]] = static_cast<uint8_t>(i + 1);
+		}
+		grown = to;
+		break;
+	}
+	case Kind::Node48:
+	{
+		auto from = static_cast<Node48*>(node_);
+		auto to = new Node256;
+		for (size_t key = 0; key < 256; ++key)
+			if (from->index[key]) to->children[key] = std::move(from->children[from->index[key] - 1]);
+		grown = to;
+		break;
+	}
+	case Kind::Node256:
+		return;
+	}
+	grown->count = node_->count;
+	destroy();
+	node_ = grown;
+}
+
+template<typename T>
+void PrefixChildren<T>::destroy()
+{
+	if (!node_) return;
+	switch (node_->kind)
+	{
+	case Kind::Node4: delete static_cast<Node4*>(node_); break;
+	case Kind::Node16: delete static_cast<Node16*>(node_); break;
+	case Kind::Node48: delete static_cast<Node48*>(node_); break;
+	case Kind::Node256: delete static_cast<Node256*>(node_); break;
+	}
+	node_ = nullptr;
+}
+
+template<typename T>
+template<typename F>
+void PrefixChildren<T>::for_each(F&& func) const
+{
+	if (!node_) return;
+	switch (node_->kind)
+	{
+	case Kind::Node4:
+	{
+		auto node = static_cast<Node4 const*>(node_);
+		for (size_t i = 0; i < node->count; ++i) func(static_cast<char>(node->keys[i]), node->children[i]);
+		break;
+	}
+	case Kind::Node16:
+	{
+		auto node = static_cast<Node16 const*>(node_);
+		for (size_t i = 0; i < node->count; ++i) func(static_cast<char>(node->keys[i]), node->children[i]);
+		break;
+	}
+	case Kind::Node48:
+	{
+		auto node = static_cast<Node48 const*>(node_);
+		for (size_t key = 0; key < 256; ++key)
+			if (node->index[key]) func(static_cast<char>(key), node->children[node->index[key] - 1]);
+		break;
+	}
+	case Kind::Node256:
+	{
+		auto node = static_cast<Node256 const*>(node_);
+		for (size_t key = 0; key < 256; ++key)
+			if (node->children[key]) func(static_cast<char>(key), node->children[key]);
+		break;
+	}
+	}
+}
+
+// The key of a node holds the bytes after the one that leads to it, so
+// a chain of nodes with one child each is a single node and a new leaf
+// keeps the whole rest of its key
 template<typename T>
 struct PrefixNode
 {
@@ -31,7 +320,7 @@ struct PrefixNode
 	std::string key;
 	value_type value;
 
-	std::unordered_map<char, PrefixLink<T>> children;
+	PrefixChildren<T> children;
 };
 
 template<typename T>
@@ -44,50 +333,41 @@ PrefixLink<T> make_prefix_node(
 
 template<typename T>
 void add_value(PrefixLink<T>& link, std::string_view key, std::optional<T>&& value)
-{	
-	if (!key.empty() && key == link->key)
+{
+	auto current = &link;
+	while (true)
 	{
-		link->value = std::forward<std::optional<T>>(value);
-		return;
-	}
+		auto& node = **current;
+		auto const common = static_cast<size_t>(std::mismatch(
+			node.key.begin(), node.key.end(), key.begin(), key.end()).first - node.key.begin());
 
-	if (key.empty() && link->key.empty())
-	{
-		link->value = std::forward<std::optional<T>>(value);
-		return;
-	}
-
-	if (key.empty() && !link->key.empty())
-	{
-		link->children[link->key[0]] = make_prefix_node(
-			{link->key.data() + 1},
-			std::forward<std::optional<T>>(link->value));
-		link->key = "";
-		link->value = std::forward<std::optional<T>>(value);
-		return;
-	}
+		// The key leaves the node inside its compressed bytes: a new node
+		// takes the common part and the old one goes under it
+		if (common < node.key.size())
+		{
+			auto parent = make_prefix_node<T>(std::string_view{node.key}.substr(0, common));
+			auto const edge = node.key[common];
+			node.key.erase(0, common + 1);
+			parent->children.insert(edge, std::move(*current));
+			*current = std::move(parent);
+		}
 
-	if (link->children.empty())
-	{
-		if (!link->key.empty())
+		key.remove_prefix(common);
+		if (key.empty())
 		{
-			link->children[link->key[0]] = make_prefix_node(
-				{link->key.data() + 1},
-				std::forward<std::optional<T>>(link->value));
-			link->key = "";
-			link->value = std::nullopt;
+			(*current)->value = std::forward<std::optional<T>>(value);
+			return;
 		}
-	}
 
-	if (auto found = link->children.find(key[0]); found == std::end(link->children))
-	{
-		link->children[key[0]] = make_prefix_node(
-			{key.data() + 1},
-			std::forward<std::optional<T>>(value));
-		return;
+		auto const edge = key[0];
+		key.remove_prefix(1);
+		if (auto child = (*current)->children.find(edge)) current = child;
+		else
+		{
+			(*current)->children.insert(edge, make_prefix_node(key, std::forward<std::optional<T>>(value)));
+			return;
+		}
 	}
-	
-	add_value(link->children[key[0]], {key.data() + 1}, std::forward<std::optional<T>>(value));
 }
 
 template<typename T>
@@ -101,17 +381,162 @@ PrefixTree<T> make_prefix_tree(std::vector<std::pair<std::string, T>> const& dat
 	return tree;
 }
 
+// Heap bytes of the tree: its nodes, the layouts of their children and
+// the keys too long for the inline buffer of a string
+template<typename T>
+size_t heap_size(PrefixLink<T> const& link)
+{
+	size_t bytes = 0;
+	std::vector<PrefixNode<T> const*> stack;
+	if (link) stack.push_back(link.get());
+	while (!stack.empty())
+	{
+		auto const node = stack.back();
+		stack.pop_back();
+		bytes += sizeof(PrefixNode<T>) + node->children.heap_size();
+		if (node->key.capacity() > std::string{}.capacity()) bytes += node->key.capacity() + 1;
+		node->children.for_each([&stack](char, PrefixLink<T> const& child) { stack.push_back(child.get()); });
+	}
+	return bytes;
+}
+
+// Node where the key ends, the node may hold no value
+template<typename T>
+PrefixNode<T> const* find_node(PrefixLink<T> const& link, std::string_view key)
+{
+	for (auto node = link.get(); node;)
+	{
+		if (key.substr(0, node->key.size()) != node->key) return nullptr;
+		key.remove_prefix(node->key.size());
+		if (key.empty()) return node;
+		auto const child = node->children.find(key[0]);
+		key.remove_prefix(1);
+		node = child ? child->get() : nullptr;
+	}
+	return nullptr;
+}
+
 template<typename T>
-T find(PrefixLink<T> const& link, std::string const& key)
+T const* find_value(PrefixLink<T> const& link, std::string_view key)
 {
-	if (!link) throw "not found";
-	if (key == link->key) return *link->value;
+	auto const node = find_node(link, key);
+	return node && node->value ? &*node->value : nullptr;
+}
 
-	if (auto found = link->children.find(key[0]); found != std::end(link->children))
+template<typename T>
+T find(PrefixLink<T> const& link, std::string_view key)
+{
+	if (auto const value = find_value(link, key)) return *value;
+	throw std::runtime_error{"not found"};
+}
+
+template<typename T>
+struct PrefixMatch
+{
+	size_t length{0};
+	T const* value{nullptr};
+};
+
+// Longest key with a value that starts the given one, as a routing table
+// picks the most specific route
+template<typename T>
+PrefixMatch<T> longest_prefix_match(PrefixLink<T> const& link, std::string_view key)
+{
+	PrefixMatch<T> match;
+	size_t length = 0;
+	for (auto node = link.get(); node;)
 	{
-		return find(found->second, {key.data() + 1});
+		if (key.substr(0, node->key.size()) != node->key) break;
+		key.remove_prefix(node->key.size());
+		length += node->key.size();
+		if (node->value) match = {length, &*node->value};
+		if (key.empty()) break;
+		auto const child = node->children.find(key[0]);
+		key.remove_prefix(1);
+		++length;
+		node = child ? child->get() : nullptr;
 	}
-	throw "not found";
+	return match;
+}
+
+namespace
+{
+
+// Calls func(key, value) for the subtree in lexicographic order, the key
+// grows and shrinks in one buffer
+template<typename T, typename F>
+void for_each_below(PrefixNode<T> const& node, std::string& key, F& func)
+{
+	auto const size = key.size();
+	key += node.key;
+	if (node.value) func(std::string_view{key}, *node.value);
+	node.children.for_each([&key, &func](char edge, PrefixLink<T> const& child)
+	{
+		key += edge;
+		for_each_below(*child, key, func);
+		key.pop_back();
+	});
+	key.resize(size);
+}
+
+} // namespace
+
+// func(key, value) for the keys starting with the prefix in lexicographic
+// order of their bytes, the key view lasts for the call only
+template<typename T, typename F>
+void for_each_with_prefix(PrefixLink<T> const& link, std::string_view prefix, F&& func)
+{
+	std::string key;
+	for (auto node = link.get(); node;)
+	{
+		// The prefix may end inside the bytes of the node
+		auto const common = std::min(prefix.size(), node->key.size());
+		if (prefix.substr(0, common) != std::string_view{node->key}.substr(0, common)) return;
+		prefix.remove_prefix(common);
+		if (prefix.empty())
+		{
+			for_each_below(*node, key, func);
+			return;
+		}
+		key += node->key;
+		key += prefix[0];
+		auto const child = node->children.find(prefix[0]);
+		prefix.remove_prefix(1);
+		node = child ? child->get() : nullptr;
+	}
+}
+
+// The k keys with the greatest values among those starting with the
+// prefix, greatest first and equal values in key order
+template<typename T>
+std::vector<std::pair<std::string, T>> top_with_prefix(PrefixLink<T> const& link, std::string_view prefix, size_t k)
+{
+	using Entry = std::pair<std::string, T>;
+	auto const before = [](Entry const& lhs, Entry const& rhs)
+	{
+		return rhs.second < lhs.second || (!(lhs.second < rhs.second) && lhs.first < rhs.first);
+	};
+
+	// Heap of the best k so far with the worst on top, keys come in order
+	// so a later one only replaces it with a strictly greater value
+	std::vector<Entry> best;
+	if (k == 0) return best;
+	for_each_with_prefix(link, prefix, [&best, &before, k](std::string_view key, T const& value)
+	{
+		if (best.size() < k)
+		{
+			best.emplace_back(key, value);
+			std::push_heap(best.begin(), best.end(), before);
+		}
+		else if (best.front().second < value)
+		{
+			std::pop_heap(best.begin(), best.end(), before);
+			best.back() = {std::string{key}, value};
+			std::push_heap(best.begin(), best.end(), before);
+		}
+	});
+	std::sort(best.begin(), best.end(), before);
+	return best;
 }
 
 } // namespace taiga
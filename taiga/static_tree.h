@@ -0,0 +1,155 @@
+﻿#ifndef _STATIC_TREE_H_
+#define _STATIC_TREE_H_
+
+#include "tree.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace taiga
+{
+
+// Immutable search tree in Eytzinger layout: the children of the node at
+// k are at 2k and 2k + 1, so the top levels share cache lines and the
+// search descends without branches on the comparisons. Built from
+// sorted values in O(n), equal values are kept
+template<typename T>
+class StaticTree
+{
+public:
+	StaticTree() = default;
+	explicit StaticTree(std::vector<T> const& sorted): nodes_(sorted.size() + 1)
+	{
+		size_t next = 0;
+		build(sorted, next, 1);
+	}
+
+	size_t size() const { return nodes_.empty() ? 0 : nodes_.size() - 1; }
+	bool empty() const { return size() == 0; }
+
+	// Index of the first node not less than the value, 0 when there is none
+	size_t lower_bound(T const& value) const
+	{
+		size_t k = 1;
+		while (k < nodes_.size())
+		{
+#ifdef __GNUC__
+			__builtin_prefetch(nodes_.data() + std::min(16 * k, nodes_.size() - 1));
+#endif
+			k = 2 * k + (nodes_[k] < value);
+		}
+		// Drop the right turns taken after the last left one and that one
+		while (k & 1) k >>= 1;
+		k >>= 1;
+		return k;
+	}
+
+	T const* find(T const& value) const
+	{
+		auto const k = lower_bound(value);
+		return k != 0 && !(value < nodes_[k]) ? &nodes_[k] : nullptr;
+	}
+
+	T const& operator[](size_t k) const { return nodes_[k]; }
+
+	static size_t left(size_t k) { return 2 * k; }
+	static size_t right(size_t k) { return 2 * k + 1; }
+	bool contains(size_t k) const { return k != 0 && k < nodes_.size(); }
+
+private:
+	void build(std::vector<T> const& sorted, size_t& next, size_t k)
+	{
+		if (k >= nodes_.size()) return;
+		build(sorted, next, 2 * k);
+		nodes_[k] = sorted[next++];
+		build(sorted, next, 2 * k + 1);
+	}
+
+	std::vector<T> nodes_;
+};
+
+template<typename T>
+StaticTree<T> make_static_tree(std::vector<T> const& sorted = {})
+{
+	return StaticTree<T>{sorted};
+}
+
+// The traversals walk the implicit links without a stack: a finished
+// subtree is left by dropping the right turns of its index
+template<typename T, typename F>
+void forward_traverse(StaticTree<T> const& tree, F&& func)
+{
+	size_t k = 1;
+	while (tree.contains(k))
+	{
+		func(tree[k]);
+		if (tree.contains(tree.left(k))) k = tree.left(k);
+		else
+		{
+			while (k & 1) k >>= 1;
+			while (k != 0 && !tree.contains(k + 1))
+			{
+				k >>= 1;
+				while (k & 1) k >>= 1;
+			}
+			if (k == 0) return;
+			++k;
+		}
+	}
+}
+
+template<typename T, typename F>
+void symmetric_traverse(StaticTree<T> const& tree, F&& func)
+{
+	if (tree.empty()) return;
+	size_t k = 1;
+	while (tree.contains(tree.left(k))) k = tree.left(k);
+	while (k != 0)
+	{
+		func(tree[k]);
+		if (tree.contains(tree.right(k)))
+		{
+			k = tree.right(k);
+			while (tree.contains(tree.left(k))) k = tree.left(k);
+		}
+		else
+		{
+			while (k & 1) k >>= 1;
+			k >>= 1;
+		}
+	}
+}
+
+template<typename T, typename F>
+void backward_traverse(StaticTree<T> const& tree, F&& func)
+{
+	if (tree.empty()) return;
+	auto leftmost_leaf = [&tree](size_t k)
+	{
+		while (true)
+		{
+			if (tree.contains(tree.left(k))) k = tree.left(k);
+			else if (tree.contains(tree.right(k))) k = tree.right(k);
+			else return k;
+		}
+	};
+
+	auto k = leftmost_leaf(1);
+	while (true)
+	{
+		func(tree[k]);
+		if (k == 1) return;
+		if ((k & 1) == 0 && tree.contains(k + 1)) k = leftmost_leaf(k + 1);
+		else k >>= 1;
+	}
+}
+
+template<typename T, typename F>
+void level_traverse(StaticTree<T> const& tree, F&& func)
+{
+	for (size_t k = 1; tree.contains(k); ++k) func(tree[k]);
+}
+
+} // namespace taiga
+
+#endif // _STATIC_TREE_H_
@@ -1,6 +1,7 @@
 ﻿#ifndef _THREAD_TREE_H_
 #define _THREAD_TREE_H_
 
+#include "balanced_tree.h"
 #include "tree.h"
 
 namespace taiga
@@ -14,11 +15,14 @@ using ThreadLink = Link<T, Threads<T>>;
 template<typename T>
 using NodePtr = Node<T, Threads<T>> const*;
 
+// Threads lead to the neighbours in order where a child is missing, the
+// height keeps the tree balanced under add_thread_node and erase_thread_node
 template<typename T>
 struct Threads
 {
 	NodePtr<T> left{nullptr};
 	NodePtr<T> right{nullptr}; 
+	int height{1};
 };
 
 template<typename T>
@@ -33,6 +37,43 @@ ThreadLink<T> make_thread_node(
 template<typename T>
 using ThreadTree = ThreadLink<T>;
 
+template<typename T>
+void update_node(Node<T, Threads<T>>& node)
+{
+	node.thread.height = 1 + std::max(height(node.left), height(node.right));
+}
+
+template<typename T>
+void balance_node(Node<T, Threads<T>>& node, bool)
+{
+	update_node(node);
+}
+
+// Rotations move the threads of the two nodes that gain or lose a child,
+// the AVL rebalancing of balanced_tree.h picks them for thread trees
+template<typename T>
+void rotate_left(ThreadLink<T>& link)
+{
+	auto right = std::move(link->right);
+	link->right = std::move(right->left);
+	if (!link->right) link->thread.right = right.get();
+	right->thread.left = nullptr;
+	right->left = std::move(link);
+	link = std::move(right);
+}
+
+template<typename T>
+void rotate_right(ThreadLink<T>& link)
+{
+	auto left = std::move(link->left);
+	link->left = std::move(left->right);
+	if (!link->left) link->thread.left = left.get();
+	left->thread.right = nullptr;
+	left->right = std::move(link);
+	link = std::move(left);
+}
+
+// Plain insertion, the shape follows the order of the values
 template<typename T>
 void add_link_thread_node(ThreadLink<T>& link, T&& value)
 {
@@ -60,13 +101,88 @@ void add_link_thread_node(ThreadLink<T>& link, T&& value)
 			link->thread.right = nullptr;
 		}
 	}
+	update_node(*link);
+}
+
+namespace
+{
+
+// Unlinks a node with one child at most, the neighbour in order that
+// had a thread to it takes over the thread of the node
+template<typename T>
+void unlink_thread_node(TreePath<T, Threads<T>>& path)
+{
+	auto& link = path.back();
+	if (link->right)
+	{
+		auto first = link->right.get();
+		while (first->left) first = first->left.get();
+		first->thread.left = link->thread.left;
+	}
+	else if (link->left)
+	{
+		auto last = link->left.get();
+		while (last->right) last = last->right.get();
+		last->thread.right = link->thread.right;
+	}
+	else if (path.size > 1)
+	{
+		auto& parent = path[path.size - 2];
+		if (&parent->left == &link) parent->thread.left = link->thread.left;
+		else parent->thread.right = link->thread.right;
+	}
+	unlink_node(link);
 }
 
+} // namespace
+
+// AVL insertion, the new leaf takes the thread of its parent on its side
 template<typename T>
 void add_thread_node(ThreadLink<T>& tree, T&& value)
 {
-	if (tree) add_link_thread_node(tree, std::forward<T>(value));
+	TreePath<T, Threads<T>> path;
+	path_to_leaf(path, tree, value);
+	if (path.size > 1)
+	{
+		auto& parent = path[path.size - 2];
+		if (&parent->left == &path.back())
+		{
+			path.back() = make_thread_node(std::forward<T>(value), parent->thread.left, parent.get());
+			parent->thread.left = nullptr;
+		}
+		else
+		{
+			path.back() = make_thread_node(std::forward<T>(value), parent.get(), parent->thread.right);
+			parent->thread.right = nullptr;
+		}
+	}
 	else tree = make_thread_node(std::forward<T>(value));
+	for (auto i = path.size - 1; i-- > 0;) rebalance(path[i]);
+}
+
+// AVL erase, the value of a node with two children is replaced by its
+// successor, whose node is unlinked instead
+template<typename T>
+bool erase_thread_node(ThreadLink<T>& tree, T const& value)
+{
+	TreePath<T, Threads<T>> path;
+	if (!path_to_value(path, tree, value)) return false;
+	path_to_successor(path);
+	unlink_thread_node(path);
+	for (auto i = path.size - 1; i-- > 0;) rebalance(path[i]);
+	return true;
+}
+
+template<typename T>
+void add_node(ThreadTree<T>& tree, T&& value)
+{
+	add_thread_node(tree, std::forward<T>(value));
+}
+
+template<typename T>
+bool erase_node(ThreadTree<T>& tree, T const& value)
+{
+	return erase_thread_node(tree, value);
 }
 
 template<typename T>
@@ -80,8 +196,8 @@ ThreadLink<T> make_thread_tree(std::vector<T> const& values = {})
 	return tree;
 }
 
-template<typename T>
-void symmetric_forward_traverse(ThreadLink<T> const& link, TraverseFunctor<T> func)
+template<typename T, typename F>
+void symmetric_forward_traverse(ThreadLink<T> const& link, F&& func)
 {
 	NodePtr<T> node = link.get();
 	auto via_branch{true};
@@ -105,8 +221,8 @@ void symmetric_forward_traverse(ThreadLink<T> const& link, TraverseFunctor<T> fu
 	}
 }
 
-template<typename T>
-void symmetric_backward_traverse(ThreadLink<T> const& link, TraverseFunctor<T> func)
+template<typename T, typename F>
+void symmetric_backward_traverse(ThreadLink<T> const& link, F&& func)
 {
 	NodePtr<T> node = link.get();
 	auto via_branch{true};
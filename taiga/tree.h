@@ -2,7 +2,10 @@
 #define _TREE_H_
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <queue>
 #include <utility>
@@ -63,23 +66,70 @@ Link<T, U> make_tree(std::vector<T> const& values = {})
 	return tree;
 }
 
+// Stack of the traversals, kept inline up to the depth of any balanced
+// tree so walking one allocates nothing
+template<typename E>
+class TraverseStack
+{
+public:
+	bool empty() const { return size_ == 0; }
+	E const& top() const { return size_ <= inline_.size() ? inline_[size_ - 1] : spill_.back(); }
+
+	void push(E e)
+	{
+		if (size_ < inline_.size()) inline_[size_] = e;
+		else spill_.push_back(e);
+		++size_;
+	}
+
+	void pop()
+	{
+		if (size_ > inline_.size()) spill_.pop_back();
+		--size_;
+	}
+
+private:
+	std::array<E, 64> inline_;
+	std::vector<E> spill_;
+	size_t size_{0};
+};
+
 template<typename T, typename U = Thread>
 int depth_tree(Link<T, U> const& link, int level = 0)
 {
-	auto left_level = link->left ? depth_tree(link->left, level + 1) : level;
-	auto right_level = link->right ? depth_tree(link->right, level + 1) : level;
-	return std::max(left_level, right_level);
+	if (!link) return level;
+	auto depth = level;
+	TraverseStack<std::pair<Node<T, U> const*, int>> stack;
+	stack.push({link.get(), level});
+	while (!stack.empty())
+	{
+		auto const [node, at] = stack.top();
+		stack.pop();
+		depth = std::max(depth, at);
+		if (node->right) stack.push({node->right.get(), at + 1});
+		if (node->left) stack.push({node->left.get(), at + 1});
+	}
+	return depth;
 }
 
 template<typename T>
 using TraverseFunctor = std::function<void(T const&)>;
 
-template<typename T, typename U = Thread>
-void forward_traverse(Link<T, U> const& link, TraverseFunctor<T> func)
+// The traversals take any callable and walk with an explicit stack
+template<typename T, typename U = Thread, typename F>
+void forward_traverse(Link<T, U> const& link, F&& func)
 {
-	func(link->value);
-	if (link->left) forward_traverse(link->left, func);
-	if (link->right) forward_traverse(link->right, func);
+	if (!link) return;
+	TraverseStack<Node<T, U> const*> stack;
+	stack.push(link.get());
+	while (!stack.empty())
+	{
+		auto const node = stack.top();
+		stack.pop();
+		func(node->value);
+		if (node->right) stack.push(node->right.get());
+		if (node->left) stack.push(node->left.get());
+	}
 }
 
 template<typename T, typename U = Thread>
@@ -88,24 +138,49 @@ void traverse(Link<T, U> const& link, TraverseFunctor<T> func)
 	forward_traverse<T, U>(link, func);
 }
 
-template<typename T, typename U = Thread>
-void symmetric_traverse(Link<T, U> const& link, TraverseFunctor<T> func)
+template<typename T, typename U = Thread, typename F>
+void symmetric_traverse(Link<T, U> const& link, F&& func)
 {
-	if (link->left) symmetric_traverse(link->left, func);
-	func(link->value);
-	if (link->right) symmetric_traverse(link->right, func);
+	TraverseStack<Node<T, U> const*> stack;
+	Node<T, U> const* node = link.get();
+	while (node || !stack.empty())
+	{
+		for (; node; node = node->left.get()) stack.push(node);
+		node = stack.top();
+		stack.pop();
+		func(node->value);
+		node = node->right.get();
+	}
 }
 
-template<typename T, typename U = Thread>
-void backward_traverse(Link<T, U> const& link, TraverseFunctor<T> func)
+template<typename T, typename U = Thread, typename F>
+void backward_traverse(Link<T, U> const& link, F&& func)
 {
-	if (link->left) backward_traverse(link->left, func);
-	if (link->right) backward_traverse(link->right, func);
-	func(link->value);
+	TraverseStack<Node<T, U> const*> stack;
+	Node<T, U> const* last = nullptr;
+	Node<T, U> const* node = link.get();
+	while (node || !stack.empty())
+	{
+		if (node)
+		{
+			stack.push(node);
+			node = node->left.get();
+			continue;
+		}
+		auto const top = stack.top();
+		if (top->right && top->right.get() != last)
+		{
+			node = top->right.get();
+			continue;
+		}
+		func(top->value);
+		last = top;
+		stack.pop();
+	}
 }
 
-template<typename T, typename U = Thread>
-void level_traverse(Link<T, U> const& link, TraverseFunctor<T> func)
+template<typename T, typename U = Thread, typename F>
+void level_traverse(Link<T, U> const& link, F&& func)
 {
 	std::queue<Node<T, U> const*> q;
 	q.push(link.get());
@@ -122,14 +197,135 @@ void level_traverse(Link<T, U> const& link, TraverseFunctor<T> func)
 template<typename T>
 using ModifyFunctor = std::function<void(T&)>;
 
-template<typename T, typename U = Thread>
-void apply(Link<T, U>& link, ModifyFunctor<T> func)
+template<typename T, typename U = Thread, typename F>
+void apply(Link<T, U>& link, F&& func)
 {
-	func(link->value);
-	if (link->left) apply(link->left, func);
-	if (link->right) apply(link->right, func);
+	if (!link) return;
+	TraverseStack<Node<T, U>*> stack;
+	stack.push(link.get());
+	while (!stack.empty())
+	{
+		auto const node = stack.top();
+		stack.pop();
+		func(node->value);
+		if (node->right) stack.push(node->right.get());
+		if (node->left) stack.push(node->left.get());
+	}
 }
 
+enum class Order
+{
+	Forward,
+	Symmetric,
+	Backward
+};
+
+// Iterator over the values in the order of the traversal of the same name,
+// the default constructed one is the end
+template<typename T, typename U, Order O>
+class TreeIterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using pointer = T const*;
+	using reference = T const&;
+
+	TreeIterator() = default;
+	explicit TreeIterator(Node<T, U> const* root)
+	{
+		if (!root) return;
+		if constexpr (O == Order::Forward) node_ = root;
+		else if constexpr (O == Order::Symmetric) node_ = leftmost(root);
+		else node_ = first_leaf(root);
+	}
+
+	reference operator*() const { return node_->value; }
+	pointer operator->() const { return &node_->value; }
+
+	TreeIterator& operator++()
+	{
+		if constexpr (O == Order::Forward)
+		{
+			if (node_->left)
+			{
+				if (node_->right) stack_.push(node_->right.get());
+				node_ = node_->left.get();
+			}
+			else if (node_->right) node_ = node_->right.get();
+			else node_ = pop();
+		}
+		else if constexpr (O == Order::Symmetric)
+		{
+			node_ = node_->right ? leftmost(node_->right.get()) : pop();
+		}
+		else
+		{
+			auto const parent = stack_.empty() ? nullptr : stack_.top();
+			if (parent && parent->left.get() == node_ && parent->right) node_ = first_leaf(parent->right.get());
+			else node_ = pop();
+		}
+		return *this;
+	}
+
+	TreeIterator operator++(int)
+	{
+		auto copy = *this;
+		++*this;
+		return copy;
+	}
+
+	bool operator==(TreeIterator const& other) const { return node_ == other.node_; }
+	bool operator!=(TreeIterator const& other) const { return node_ != other.node_; }
+
+private:
+	Node<T, U> const* pop()
+	{
+		if (stack_.empty()) return nullptr;
+		auto const node = stack_.top();
+		stack_.pop();
+		return node;
+	}
+
+	Node<T, U> const* leftmost(Node<T, U> const* node)
+	{
+		for (; node->left; node = node->left.get()) stack_.push(node);
+		return node;
+	}
+
+	Node<T, U> const* first_leaf(Node<T, U> const* node)
+	{
+		while (node->left || node->right)
+		{
+			stack_.push(node);
+			node = node->left ? node->left.get() : node->right.get();
+		}
+		return node;
+	}
+
+	Node<T, U> const* node_{nullptr};
+	TraverseStack<Node<T, U> const*> stack_;
+};
+
+template<typename T, typename U, Order O>
+struct TreeRange
+{
+	TreeIterator<T, U, O> first;
+
+	TreeIterator<T, U, O> begin() const { return first; }
+	TreeIterator<T, U, O> end() const { return {}; }
+};
+
+template<typename T, typename U = Thread>
+TreeRange<T, U, Order::Forward> forward_range(Link<T, U> const& link) { return {TreeIterator<T, U, Order::Forward>{link.get()}}; }
+
+template<typename T, typename U = Thread>
+TreeRange<T, U, Order::Symmetric> symmetric_range(Link<T, U> const& link) { return {TreeIterator<T, U, Order::Symmetric>{link.get()}}; }
+
+template<typename T, typename U = Thread>
+TreeRange<T, U, Order::Backward> backward_range(Link<T, U> const& link) { return {TreeIterator<T, U, Order::Backward>{link.get()}}; }
+
 template<typename T, typename U = Thread>
 Link<T, U>& find(Link<T, U> const& link, T const& v)
 {
@@ -84,8 +84,12 @@ struct ThreadTreeView : View<T, debug>
 {
 	ThreadLink<Vertex<T, debug>> root;
 
+	// The view mirrors the shape of the tree, so it skips rebalancing
 	void add_vertex(T&& value) override
-	{ add_thread_node(root, {std::forward<T>(value), {}, this->style.vertex}); }
+	{
+		if (root) add_link_thread_node(root, {std::forward<T>(value), {}, this->style.vertex});
+		else root = make_thread_node<Vertex<T, debug>>({std::forward<T>(value), {}, this->style.vertex});
+	}
 };
 
 void DrawEdge(bwgui::Application& app, Edge const& edge)